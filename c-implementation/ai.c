@@ -1,10 +1,18 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, pthreads
+
 #include "ai.h"
+#include "bitboard.h"
+#include "cells.h"
 #include <math.h>
+#include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-// Standard evaluation function
-double evaluate_standard(const Board *board) {
+// Full scan of the standard evaluation for boards without bitboards, which
+// have no piece-square tables
+static Score evaluate_standard_scan(const Board *board) {
     int white_value = 0;
     int black_value = 0;
     int num_white = 0;
@@ -44,44 +52,92 @@ double evaluate_standard(const Board *board) {
         }
     }
     
-    double evaluation = black_value - white_value;
+    Score evaluation = black_value - white_value;
     
     if (num_white == 0) {
-        evaluation = INFINITY;
+        evaluation = SCORE_WIN;
     }
     if (num_black == 0) {
-        evaluation = -INFINITY;
+        evaluation = -SCORE_WIN;
     }
     
     return evaluation;
 }
 
-// Ending game evaluation function (simpler, piece count focused)
-double evaluate_ending(const Board *board) {
-    int white_value = 0;
-    int black_value = 0;
+// Ending evaluation for boards without bitboards: men count 2, kings 3
+static Score evaluate_ending_scan(const Board *board) {
+    CellCounts counts;
+    cells_count(board->cells, board->width * board->height, &counts);
     
-    for (int i = 0; i < board->height; i++) {
-        for (int j = 0; j < board->width; j++) {
-            char piece = board_get(board, i, j);
-            
-            if (piece == 'b') {
-                white_value += 2;
-            } else if (piece == 'B') {
-                white_value += 3;
-            } else if (piece == 'c') {
-                black_value += 2;
-            } else if (piece == 'C') {
-                black_value += 3;
-            }
-        }
+    return 2 * (counts.pieces[2] - counts.pieces[0]) + 3 * (counts.pieces[3] - counts.pieces[1]);
+}
+
+// Build with -DEVAL_DEBUG to compare every incremental evaluation with a
+// full scan of the board
+#ifdef EVAL_DEBUG
+// Sum of the piece-square values of one term over the whole board, what
+// board_set keeps in board->eval[term]
+static Score evaluate_table_scan(const Board *board, int term) {
+    const int (*table)[BOARD_PIECE_KINDS] = board_eval_tables[term];
+    Score value = 0;
+    
+    for (int square = 0; square < BB_SQUARES; square++) {
+        Coordinate coord = bitboard_coordinate(square);
+        value += table[square][board_piece_kind(board_get(board, coord.row, coord.col))];
+    }
+    return value;
+}
+
+static void evaluation_check(const Board *board, int term) {
+    Score scan = evaluate_table_scan(board, term);
+    if (board->eval[term] != scan) {
+        fprintf(stderr, "evaluation term %d: incremental value %d differs from full scan %d\n",
+                term, board->eval[term], (int)scan);
+        abort();
+    }
+}
+#define EVALUATION_CHECK(board, term) evaluation_check(board, term)
+#else
+#define EVALUATION_CHECK(board, term) ((void)0)
+#endif
+
+// Standard evaluation function: piece-square values kept up to date by
+// board_set (BOARD_EVAL_STANDARD), a side without pieces has lost
+Score evaluate_standard(const Board *board) {
+    if (!board->use_bitboards) {
+        return evaluate_standard_scan(board);
+    }
+    
+    Score evaluation = board->eval[BOARD_EVAL_STANDARD];
+    if (board->white_pieces == 0) {
+        evaluation = SCORE_WIN;
+    }
+    if (board->black_pieces == 0) {
+        evaluation = -SCORE_WIN;
     }
     
-    return black_value - white_value;
+    EVALUATION_CHECK(board, BOARD_EVAL_STANDARD);
+    return evaluation;
+}
+
+// Ending game evaluation function (simpler, piece count focused)
+Score evaluate_ending(const Board *board) {
+    if (!board->use_bitboards) {
+        return evaluate_ending_scan(board);
+    }
+    
+    EVALUATION_CHECK(board, BOARD_EVAL_ENDING);
+    return board->eval[BOARD_EVAL_ENDING];
+}
+
+EvaluationFunc ai_default_evaluation(const Board *board) {
+    int num_white, num_black;
+    board_count_pieces(board, &num_white, &num_black);
+    return num_white + num_black > AI_ENDING_PIECES ? evaluate_standard : evaluate_ending;
 }
 
 // Simple minimax algorithm
-double ai_minimax(Board *board, int depth, bool max_player, EvaluationFunc eval_func) {
+Score ai_minimax(Board *board, int depth, bool max_player, EvaluationFunc eval_func) {
     if (depth == 0 || board_is_game_over(board)) {
         return eval_func(board);
     }
@@ -90,119 +146,1123 @@ double ai_minimax(Board *board, int depth, bool max_player, EvaluationFunc eval_
     board_generate_all_moves(board, false, &moves);
     
     if (max_player) {
-        double max_eval = -INFINITY;
+        Score max_eval = -SCORE_INFINITE;
         for (int i = 0; i < moves.count; i++) {
-            Board *child = board_create(board->width, board->height);
-            board_copy(child, board);
-            board_apply_move(child, &moves.moves[i]);
+            MoveUndo undo;
+            board_make_move(board, &moves.moves[i], &undo);
             
-            double eval = ai_minimax(child, depth - 1, false, eval_func);
+            Score eval = ai_minimax(board, depth - 1, false, eval_func);
             if (eval > max_eval) {
                 max_eval = eval;
             }
             
-            board_free(child);
+            board_unmake_move(board, &moves.moves[i], &undo);
         }
         return max_eval;
     } else {
-        double min_eval = INFINITY;
+        Score min_eval = SCORE_INFINITE;
         for (int i = 0; i < moves.count; i++) {
-            Board *child = board_create(board->width, board->height);
-            board_copy(child, board);
-            board_apply_move(child, &moves.moves[i]);
+            MoveUndo undo;
+            board_make_move(board, &moves.moves[i], &undo);
             
-            double eval = ai_minimax(child, depth - 1, true, eval_func);
+            Score eval = ai_minimax(board, depth - 1, true, eval_func);
             if (eval < min_eval) {
                 min_eval = eval;
             }
             
-            board_free(child);
+            board_unmake_move(board, &moves.moves[i], &undo);
         }
         return min_eval;
     }
 }
 
-// Alpha-beta pruning algorithm (decoupled from game logic)
-double ai_alpha_beta(Board *board, int depth, double alpha, double beta, bool max_player, bool forced_capture, EvaluationFunc eval_func) {
-    if (depth == 0 || board_is_game_over(board)) {
-        return eval_func(board);
+// Time control for ai_search_timed: the clock is checked every
+// SEARCH_CHECK_INTERVAL nodes and the search unwinds once the deadline passes.
+#define SEARCH_CHECK_INTERVAL 1024
+
+// Deepest ply of the per-thread move stacks, deeper nodes are evaluated
+#define SEARCH_MAX_PLY ORDERING_MAX_PLY
+
+// Late move reductions: moves searched at full depth first, the least depth
+// at which moves are reduced, and from when late moves lose two plies
+#define LMR_FULL_MOVES 3
+#define LMR_MIN_DEPTH 3
+#define LMR_DEEP_DEPTH 6
+#define LMR_LATE_MOVES 8
+
+// Scratch space of one node: its moves and the picker ordering them. Nodes
+// use the slot of their ply instead of stack frames, so the moves of a
+// whole line sit in one block of memory that is reused from search to search.
+typedef struct SearchPly {
+    MoveList moves;
+    MovePicker picker;
+} SearchPly;
+
+// Memory of one search thread, allocated on first use
+typedef struct SearchThread {
+    MoveOrdering ordering;    // killer/history tables, kept between searches
+    SearchPly plies[SEARCH_MAX_PLY];
+} SearchThread;
+
+struct SearchContext {
+    // Transposition table shared by the alpha-beta searches (NULL when
+    // disabled). Scores depend on the evaluation function, the capture rule
+    // and endgame probing, so the table is cleared whenever a search runs
+    // with different settings.
+    TranspositionTable *tt;
+    EvaluationFunc tt_eval_func;
+    bool tt_forced_capture;
+    bool tt_endgame_probing;
+    
+    // Parallel root search settings
+    int threads;
+    bool deterministic;
+    
+    bool use_move_ordering;
+    int quiescence_depth;     // plies of captures past the nominal depth (0 disables)
+    bool use_pvs;
+    bool use_aspiration;
+    bool use_lmr;
+    bool use_futility;
+    
+    // Endgame tables probed inside the search. Probing is switched off for a
+    // search whose root is already in the table: every node would get the same
+    // score, so the evaluation picks among the moves that keep the result.
+    const EndgameTable *endgame_table;
+    bool endgame_probing;
+    
+    double deadline;              // monotonic ms, 0 = no limit
+    volatile bool stopped;        // set by any search thread, read by all
+    const volatile bool *abort;   // stop request from outside the search
+    
+    SearchStats stats;            // searches since the last ai_reset_search_stats
+    SearchThread *workers[AI_MAX_THREADS];
+};
+
+static SearchThread* context_thread(SearchContext *ctx, int thread) {
+    if (!ctx->workers[thread]) {
+        ctx->workers[thread] = (SearchThread*)malloc(sizeof(SearchThread));
+        if (ctx->workers[thread]) {
+            ordering_clear(&ctx->workers[thread]->ordering);
+        }
     }
+    return ctx->workers[thread];
+}
+
+SearchContext* ai_context_create(void) {
+    SearchContext *ctx = (SearchContext*)calloc(1, sizeof(SearchContext));
+    if (!ctx) return NULL;
     
-    MoveList moves;
-    board_generate_all_moves(board, forced_capture, &moves);
+    ctx->threads = 1;
+    ctx->use_move_ordering = true;
+    ctx->quiescence_depth = AI_DEFAULT_QUIESCENCE_DEPTH;
+    ctx->use_pvs = true;
+    ctx->use_aspiration = true;
+    ctx->use_lmr = true;
+    ctx->endgame_probing = true;
+    ctx->tt_endgame_probing = true;
+    
+    // Thread 0 is the caller's, every search needs it
+    if (!context_thread(ctx, 0)) {
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+void ai_context_free(SearchContext *ctx) {
+    if (!ctx) return;
+    for (int t = 0; t < AI_MAX_THREADS; t++) {
+        free(ctx->workers[t]);
+    }
+    free(ctx);
+}
+
+void ai_set_transposition_table(SearchContext *ctx, TranspositionTable *tt) {
+    ctx->tt = tt;
+    ctx->tt_eval_func = NULL;
+}
+
+void ai_set_threads(SearchContext *ctx, int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > AI_MAX_THREADS) threads = AI_MAX_THREADS;
+    ctx->threads = threads;
+}
+
+void ai_set_deterministic(SearchContext *ctx, bool deterministic) {
+    ctx->deterministic = deterministic;
+}
+
+void ai_set_move_ordering(SearchContext *ctx, bool enabled) {
+    ctx->use_move_ordering = enabled;
+}
+
+bool ai_get_move_ordering(const SearchContext *ctx) {
+    return ctx->use_move_ordering;
+}
+
+void ai_clear_move_ordering(SearchContext *ctx) {
+    for (int t = 0; t < AI_MAX_THREADS; t++) {
+        if (ctx->workers[t]) {
+            ordering_clear(&ctx->workers[t]->ordering);
+        }
+    }
+}
+
+void ai_set_pvs(SearchContext *ctx, bool enabled) {
+    ctx->use_pvs = enabled;
+}
+
+bool ai_get_pvs(const SearchContext *ctx) {
+    return ctx->use_pvs;
+}
+
+void ai_set_aspiration(SearchContext *ctx, bool enabled) {
+    ctx->use_aspiration = enabled;
+}
+
+bool ai_get_aspiration(const SearchContext *ctx) {
+    return ctx->use_aspiration;
+}
+
+void ai_set_lmr(SearchContext *ctx, bool enabled) {
+    ctx->use_lmr = enabled;
+}
+
+bool ai_get_lmr(const SearchContext *ctx) {
+    return ctx->use_lmr;
+}
+
+void ai_set_futility(SearchContext *ctx, bool enabled) {
+    ctx->use_futility = enabled;
+}
+
+bool ai_get_futility(const SearchContext *ctx) {
+    return ctx->use_futility;
+}
+
+void ai_set_quiescence_depth(SearchContext *ctx, int plies) {
+    ctx->quiescence_depth = plies < 0 ? 0 : plies;
+    ctx->tt_eval_func = NULL;  // stored scores were computed with the old horizon
+}
+
+void ai_set_endgame_table(SearchContext *ctx, const EndgameTable *table) {
+    ctx->endgame_table = table;
+    ctx->tt_eval_func = NULL;  // stored scores may have been searched without it
+}
+
+EndgameTable* ai_load_tables(void) {
+    board_eval_load(BOARD_EVAL_FILE);
+    return endgame_open(ENDGAME_FILE);
+}
+
+void ai_set_abort_flag(SearchContext *ctx, const volatile bool *flag) {
+    ctx->abort = flag;
+}
+
+void ai_get_search_stats(const SearchContext *ctx, SearchStats *stats) {
+    *stats = ctx->stats;
+}
+
+void ai_reset_search_stats(SearchContext *ctx) {
+    memset(&ctx->stats, 0, sizeof(SearchStats));
+}
+
+// Called once per top-level search, not per iteration: killers found at
+// lower depths are still good candidates at the next one
+static void ordering_prepare(SearchContext *ctx) {
+    for (int t = 0; t < ctx->threads; t++) {
+        if (ctx->workers[t]) {
+            ordering_new_search(&ctx->workers[t]->ordering);
+        }
+    }
+}
+
+static void tt_prepare(SearchContext *ctx, bool forced_capture, EvaluationFunc eval_func) {
+    if (ctx->tt && (ctx->tt_eval_func != eval_func || ctx->tt_forced_capture != forced_capture ||
+                    ctx->tt_endgame_probing != ctx->endgame_probing)) {
+        tt_clear(ctx->tt);
+        ctx->tt_eval_func = eval_func;
+        ctx->tt_forced_capture = forced_capture;
+        ctx->tt_endgame_probing = ctx->endgame_probing;
+    }
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// State of one search thread. Every thread works on its own board with
+// make/unmake; only the transposition table is shared.
+typedef struct SearchState {
+    SearchContext *ctx;
+    Board *board;
+    bool forced_capture;
+    EvaluationFunc eval_func;
+    TranspositionTable *tt;   // NULL when disabled or the board has no hash
+    MoveOrdering *ordering;   // NULL when move ordering is disabled
+    const EndgameTable *endgame;  // NULL when not probed in this search
+    SearchPly *plies;         // move stack of the thread, indexed by ply
+    Score futility_margin;    // 0 when futility pruning is off
+    SearchStats stats;        // added to the context once the search is over
+    TTStats tt_stats;         // added to the table once the search is over
+} SearchState;
+
+// Most a quiet move plus a man won in an exchange can change the
+// evaluation, from the piece-square tables behind it; 0 for evaluations
+// that are not built from them
+static Score futility_margin(EvaluationFunc eval_func) {
+    int term = eval_func == evaluate_standard ? BOARD_EVAL_STANDARD :
+               eval_func == evaluate_ending ? BOARD_EVAL_ENDING : -1;
+    if (term < 0) return 0;
+    
+    // Kinds 0-3 are b, B, c, C; white values are negative
+    int swing = 0;
+    int man = 0;
+    for (int kind = 0; kind < 4; kind++) {
+        int low = abs(board_eval_tables[term][0][kind]);
+        int high = low;
+        for (int square = 1; square < BB_SQUARES; square++) {
+            int value = abs(board_eval_tables[term][square][kind]);
+            if (value < low) low = value;
+            if (value > high) high = value;
+        }
+        if (high - low > swing) swing = high - low;
+        if ((kind == 0 || kind == 2) && high > man) man = high;
+    }
+    return swing + man;
+}
+
+// `thread` must have been allocated with context_thread
+static void search_state_init(SearchState *state, SearchContext *ctx, int thread, Board *board,
+                              bool forced_capture, EvaluationFunc eval_func) {
+    memset(state, 0, sizeof(SearchState));
+    state->ctx = ctx;
+    state->board = board;
+    state->forced_capture = forced_capture;
+    state->eval_func = eval_func;
+    state->tt = board->use_bitboards ? ctx->tt : NULL;
+    state->ordering = ctx->use_move_ordering ? &ctx->workers[thread]->ordering : NULL;
+    state->plies = ctx->workers[thread]->plies;
+    state->futility_margin = ctx->use_futility ? futility_margin(eval_func) : 0;
+    
+    // A table built for the other capture rule has different values
+    if (ctx->endgame_table && ctx->endgame_probing &&
+        endgame_forced_capture(ctx->endgame_table) == forced_capture) {
+        state->endgame = ctx->endgame_table;
+    }
+}
+
+// Runs on the thread that started the search, after the workers joined
+static void search_state_finish(SearchState *state) {
+    SearchStats *stats = &state->ctx->stats;
+    if (state->tt) {
+        tt_add_stats(state->tt, &state->tt_stats);
+    }
+    stats->nodes += state->stats.nodes;
+    stats->leaf_evals += state->stats.leaf_evals;
+    stats->quiescence_nodes += state->stats.quiescence_nodes;
+    stats->cutoffs += state->stats.cutoffs;
+    for (int i = 0; i < AI_STATS_CUTOFF_SLOTS; i++) {
+        stats->cutoffs_by_move[i] += state->stats.cutoffs_by_move[i];
+    }
+    stats->tt_probes += state->tt_stats.probes;
+    stats->tt_hits += state->tt_stats.hits;
+    stats->endgame_hits += state->stats.endgame_hits;
+    stats->reductions += state->stats.reductions;
+    stats->reduction_researches += state->stats.reduction_researches;
+    stats->futility_pruned += state->stats.futility_pruned;
+    if (state->stats.max_ply > stats->max_ply) {
+        stats->max_ply = state->stats.max_ply;
+    }
+}
+
+static inline bool search_should_stop(SearchState *state, int ply) {
+    SearchContext *ctx = state->ctx;
+    state->stats.nodes++;
+    if (ply > state->stats.max_ply) {
+        state->stats.max_ply = ply;
+    }
+    if ((state->stats.nodes % SEARCH_CHECK_INTERVAL) == 0 &&
+        ((ctx->abort && *ctx->abort) || (ctx->deadline > 0 && now_ms() >= ctx->deadline))) {
+        ctx->stopped = true;
+    }
+    return ctx->stopped;
+}
+
+static void record_cutoff(SearchState *state, const Move *move, int depth, int ply, int searched) {
+    state->stats.cutoffs++;
+    state->stats.cutoffs_by_move[searched < AI_STATS_CUTOFF_SLOTS ? searched - 1 : AI_STATS_CUTOFF_SLOTS - 1]++;
+    if (state->ordering) {
+        ordering_record_cutoff(state->ordering, state->board, move, depth, ply);
+    }
+}
+
+// A move that neither captures nor crowns a man
+static inline bool is_quiet_move(const Board *board, const Move *move) {
+    if (move->is_capture) return false;
+    
+    char piece = board_get(board, move->from.row, move->from.col);
+    int promotion_row = piece == 'b' ? 0 : (piece == 'c' ? board->height - 1 : -1);
+    return move->to.row != promotion_row;
+}
+
+// Plies by which the `searched`-th move of a node is searched less deep.
+// None in deterministic mode: the move order comes from each thread's own
+// killers and history, so reductions would depend on the thread count.
+static inline int late_move_reduction(const SearchState *state, int depth, int searched, bool quiet) {
+    if (!state->ctx->use_lmr || state->ctx->deterministic || !quiet || depth < LMR_MIN_DEPTH || searched <= LMR_FULL_MOVES) {
+        return 0;
+    }
+    return depth >= LMR_DEEP_DEPTH && searched > LMR_LATE_MOVES ? 2 : 1;
+}
+
+static inline Score evaluate(SearchState *state) {
+    state->stats.leaf_evals++;
+    return state->eval_func(state->board);
+}
+
+// Score of the side to move losing now, `ply` plies from the root
+static inline Score lost_score(const Board *board, int ply) {
+    return board->white_to_move ? SCORE_WIN - ply : -(SCORE_WIN - ply);
+}
+
+// Score of a table result: a decided game at its exact distance, or just
+// beyond the longest distance a table stores when the file has none, so a
+// proven win in n plies is still preferred
+static Score endgame_score(const Board *board, const EndgameResult *result, int ply) {
+    if (result->value == 0) {
+        return 0;
+    }
+    int distance = result->distance >= 0 ? result->distance : ENDGAME_MAX_DISTANCE + 1;
+    Score score = SCORE_WIN - ply - distance;
+    if (result->value < 0) {
+        score = -score;
+    }
+    return board->white_to_move ? -score : score;
+}
+
+// Scores of decided games count plies from the root; the table stores them
+// counted from the position itself so they stay valid at any ply
+static inline Score score_to_tt(Score score, int ply) {
+    if (score >= SCORE_DECIDED) return score + ply;
+    if (score <= -SCORE_DECIDED) return score - ply;
+    return score;
+}
+
+static inline Score score_from_tt(Score score, int ply) {
+    if (score >= SCORE_DECIDED) return score - ply;
+    if (score <= -SCORE_DECIDED) return score + ply;
+    return score;
+}
+
+// Capture-only search below the horizon, so leaves are never evaluated in
+// the middle of an exchange. Without the forced capture rule the side to
+// move may decline the captures: the static evaluation is then a bound
+// (stand pat) and can end the node on its own.
+static Score quiescence(SearchState *state, int qdepth, int ply, Score alpha, Score beta, bool max_player) {
+    Board *board = state->board;
+    
+    if (search_should_stop(state, ply)) {
+        return 0;
+    }
+    state->stats.quiescence_nodes++;
+    
+    // Forced generation returns only captures whenever one exists
+    MoveList *moves = &state->plies[ply].moves;
+    board_generate_all_moves(board, true, moves);
+    if (moves->count == 0) {
+        return lost_score(board, ply);
+    }
+    if (!moves->moves[0].is_capture || qdepth >= state->ctx->quiescence_depth || ply + 1 >= SEARCH_MAX_PLY) {
+        return evaluate(state);
+    }
+    
+    Score best_eval = max_player ? -SCORE_INFINITE : SCORE_INFINITE;
+    if (!state->forced_capture) {
+        Score stand_pat = evaluate(state);
+        if (max_player ? stand_pat >= beta : stand_pat <= alpha) {
+            return stand_pat;
+        }
+        best_eval = stand_pat;
+        if (max_player && stand_pat > alpha) alpha = stand_pat;
+        if (!max_player && stand_pat < beta) beta = stand_pat;
+    }
+    
+    for (int i = 0; i < moves->count; i++) {
+        MoveUndo undo;
+        board_make_move(board, &moves->moves[i], &undo);
+        
+        Score eval = quiescence(state, qdepth + 1, ply + 1, alpha, beta, !max_player);
+        
+        board_unmake_move(board, &moves->moves[i], &undo);
+        
+        if (state->ctx->stopped) {
+            return 0;
+        }
+        
+        if (max_player) {
+            if (eval > best_eval) best_eval = eval;
+            if (eval > alpha) alpha = eval;
+        } else {
+            if (eval < best_eval) best_eval = eval;
+            if (eval < beta) beta = eval;
+        }
+        if (beta <= alpha) {
+            break;
+        }
+    }
+    
+    return best_eval;
+}
+
+static Score alpha_beta(SearchState *state, int depth, int ply, Score alpha, Score beta, bool max_player) {
+    Board *board = state->board;
+    
+    if (search_should_stop(state, ply)) {
+        return 0;
+    }
+    
+    EndgameResult endgame;
+    if (state->endgame && ply > 0 && endgame_probe(state->endgame, board, &endgame)) {
+        state->stats.endgame_hits++;
+        return endgame_score(board, &endgame, ply);
+    }
+    
+    // Quiescence generates the moves and detects a lost position itself;
+    // interior nodes use the move list they search (below)
+    if (depth == 0 || ply + 1 >= SEARCH_MAX_PLY) {
+        if (state->ctx->quiescence_depth > 0) {
+            return quiescence(state, 0, ply, alpha, beta, max_player);
+        }
+        if (!board_has_moves(board)) {
+            return lost_score(board, ply);
+        }
+        return evaluate(state);
+    }
+    
+    // Deterministic mode only trusts entries of exactly this depth: their
+    // values do not depend on which thread stored them or when
+    TranspositionTable *tt = state->tt;
+    int hash_from = -1;
+    int hash_to = -1;
+    if (tt) {
+        TTEntry entry;
+        state->tt_stats.probes++;
+        if (tt_probe(tt, board->hash, &entry)) {
+            state->tt_stats.hits++;
+            if (state->ordering && entry.best_from != TT_NO_MOVE) {
+                hash_from = entry.best_from;
+                hash_to = entry.best_to;
+            }
+            Score score = score_from_tt(entry.score, ply);
+            bool usable = state->ctx->deterministic ? entry.depth == depth : entry.depth >= depth;
+            if (usable && (entry.bound == TT_EXACT ||
+                           (entry.bound == TT_LOWER && score >= beta) ||
+                           (entry.bound == TT_UPPER && score <= alpha))) {
+                state->tt_stats.cutoffs++;
+                return score;
+            }
+        }
+    }
+    
+    Score alpha_orig = alpha;
+    Score beta_orig = beta;
+    
+    MoveList *moves = &state->plies[ply].moves;
+    board_generate_all_moves(board, state->forced_capture, moves);
+    if (moves->count == 0) {
+        return lost_score(board, ply);
+    }
+    
+    MovePicker *picker = &state->plies[ply].picker;
+    picker_init(picker, moves, board, state->ordering, ply, hash_from, hash_to);
+    bool pvs = state->ctx->use_pvs;
+    
+    // Futility: the children are leaves, and even the best quiet move
+    // cannot bring the static evaluation back into the window
+    bool futile = false;
+    Score futility_value = 0;
+    if (depth == 1 && state->futility_margin > 0 && !score_is_decided(alpha) && !score_is_decided(beta)) {
+        Score static_eval = evaluate(state);
+        futility_value = max_player ? static_eval + state->futility_margin : static_eval - state->futility_margin;
+        futile = max_player ? futility_value <= alpha : futility_value >= beta;
+    }
+    
+    Score best_eval;
+    int best_index = -1;
+    int searched = 0;
+    int i;
     
     if (max_player) {
-        double max_eval = -INFINITY;
-        for (int i = 0; i < moves.count; i++) {
-            Board *child = board_create(board->width, board->height);
-            board_copy(child, board);
-            board_apply_move(child, &moves.moves[i]);
+        best_eval = -SCORE_INFINITE;
+        while ((i = picker_next(picker)) >= 0) {
+            bool quiet = is_quiet_move(board, &moves->moves[i]);
+            if (futile && quiet && searched > 0) {
+                state->stats.futility_pruned++;
+                if (futility_value > best_eval) best_eval = futility_value;
+                continue;
+            }
             
-            double eval = ai_alpha_beta(child, depth - 1, alpha, beta, false, forced_capture, eval_func);
+            MoveUndo undo;
+            board_make_move(board, &moves->moves[i], &undo);
+            searched++;
             
-            board_free(child);
+            // LMR: a late quiet move first has to beat alpha at reduced depth
+            Score eval = 0;
+            bool full = true;
+            int reduction = late_move_reduction(state, depth, searched, quiet);
+            if (reduction > 0) {
+                state->stats.reductions++;
+                eval = alpha_beta(state, depth - 1 - reduction, ply + 1, alpha, alpha + 1, false);
+                full = eval > alpha && !state->ctx->stopped;
+                state->stats.reduction_researches += full;
+            }
             
-            if (eval > max_eval) {
-                max_eval = eval;
+            // PVS: after the first move, only prove that a move is no
+            // better than alpha; re-search the ones that are
+            if (full && pvs && searched > 1) {
+                eval = alpha_beta(state, depth - 1, ply + 1, alpha, alpha + 1, false);
+                if (eval > alpha && eval < beta && !state->ctx->stopped) {
+                    eval = alpha_beta(state, depth - 1, ply + 1, alpha, beta, false);
+                }
+            } else if (full) {
+                eval = alpha_beta(state, depth - 1, ply + 1, alpha, beta, false);
+            }
+            
+            board_unmake_move(board, &moves->moves[i], &undo);
+            
+            if (state->ctx->stopped) {
+                return 0;  // Result of an aborted search is never used
+            }
+            
+            if (eval > best_eval || best_index < 0) {
+                best_eval = eval;
+                best_index = i;
             }
             if (eval > alpha) {
                 alpha = eval;
             }
             if (beta <= alpha) {
+                record_cutoff(state, &moves->moves[i], depth, ply, searched);
                 break;  // Beta cutoff
             }
         }
-        return max_eval;
     } else {
-        double min_eval = INFINITY;
-        for (int i = 0; i < moves.count; i++) {
-            Board *child = board_create(board->width, board->height);
-            board_copy(child, board);
-            board_apply_move(child, &moves.moves[i]);
+        best_eval = SCORE_INFINITE;
+        while ((i = picker_next(picker)) >= 0) {
+            bool quiet = is_quiet_move(board, &moves->moves[i]);
+            if (futile && quiet && searched > 0) {
+                state->stats.futility_pruned++;
+                if (futility_value < best_eval) best_eval = futility_value;
+                continue;
+            }
             
-            double eval = ai_alpha_beta(child, depth - 1, alpha, beta, true, forced_capture, eval_func);
+            MoveUndo undo;
+            board_make_move(board, &moves->moves[i], &undo);
+            searched++;
             
-            board_free(child);
+            Score eval = 0;
+            bool full = true;
+            int reduction = late_move_reduction(state, depth, searched, quiet);
+            if (reduction > 0) {
+                state->stats.reductions++;
+                eval = alpha_beta(state, depth - 1 - reduction, ply + 1, beta - 1, beta, true);
+                full = eval < beta && !state->ctx->stopped;
+                state->stats.reduction_researches += full;
+            }
             
-            if (eval < min_eval) {
-                min_eval = eval;
+            if (full && pvs && searched > 1) {
+                eval = alpha_beta(state, depth - 1, ply + 1, beta - 1, beta, true);
+                if (eval < beta && eval > alpha && !state->ctx->stopped) {
+                    eval = alpha_beta(state, depth - 1, ply + 1, alpha, beta, true);
+                }
+            } else if (full) {
+                eval = alpha_beta(state, depth - 1, ply + 1, alpha, beta, true);
+            }
+            
+            board_unmake_move(board, &moves->moves[i], &undo);
+            
+            if (state->ctx->stopped) {
+                return 0;  // Result of an aborted search is never used
+            }
+            
+            if (eval < best_eval || best_index < 0) {
+                best_eval = eval;
+                best_index = i;
             }
             if (eval < beta) {
                 beta = eval;
             }
             if (beta <= alpha) {
+                record_cutoff(state, &moves->moves[i], depth, ply, searched);
                 break;  // Alpha cutoff
             }
         }
-        return min_eval;
     }
+    
+    if (tt) {
+        TTBound bound = TT_EXACT;
+        if (best_eval <= alpha_orig) {
+            bound = TT_UPPER;
+        } else if (best_eval >= beta_orig) {
+            bound = TT_LOWER;
+        }
+        
+        const Move *best = &moves->moves[best_index];
+        state->tt_stats.stores++;
+        if (tt_store(tt, board->hash, depth, bound, score_to_tt(best_eval, ply),
+                     board_index(board, best->from.row, best->from.col),
+                     board_index(board, best->to.row, best->to.col))) {
+            state->tt_stats.overwrites++;
+        }
+    }
+    
+    return best_eval;
+}
+
+// Alpha-beta pruning algorithm (decoupled from game logic)
+Score ai_alpha_beta(SearchContext *ctx, Board *board, int depth, Score alpha, Score beta, bool max_player,
+                    bool forced_capture, EvaluationFunc eval_func) {
+    tt_prepare(ctx, forced_capture, eval_func);
+    
+    SearchState state;
+    search_state_init(&state, ctx, 0, board, forced_capture, eval_func);
+    Score eval = alpha_beta(&state, depth, 0, alpha, beta, max_player);
+    search_state_finish(&state);
+    
+    return eval;
+}
+
+// Root moves are handed out one at a time to the search threads and
+// searched inside the aspiration window [window_alpha, window_beta]. Outside
+// deterministic mode every move is searched against the best score found so
+// far (with a null window first when PVS is on); moves that fail low only
+// get a bound and cannot become the best move.
+typedef struct RootSearch {
+    MoveList moves;
+    int depth;
+    bool max_player;
+    Score window_alpha;
+    Score window_beta;
+    pthread_mutex_t lock;
+    int next;                   // next move to hand out
+    int completed;
+    Score bound;                // best exact score so far
+    Score evals[MAX_MOVES];
+    bool exact[MAX_MOVES];      // evals[i] is the move's value, not just a bound
+} RootSearch;
+
+typedef struct RootWorker {
+    RootSearch *root;
+    SearchState state;
+} RootWorker;
+
+static void root_worker_run(RootWorker *worker) {
+    RootSearch *root = worker->root;
+    SearchContext *ctx = worker->state.ctx;
+    Board *board = worker->state.board;
+    
+    while (!ctx->stopped) {
+        pthread_mutex_lock(&root->lock);
+        int i = root->next++;
+        Score bound = root->bound;
+        pthread_mutex_unlock(&root->lock);
+        
+        if (i >= root->moves.count) {
+            break;
+        }
+        
+        Score alpha = root->window_alpha;
+        Score beta = root->window_beta;
+        if (!ctx->deterministic) {
+            if (root->max_player) {
+                alpha = bound;
+            } else {
+                beta = bound;
+            }
+        }
+        
+        MoveUndo undo;
+        board_make_move(board, &root->moves.moves[i], &undo);
+        Score eval;
+        bool scout = ctx->use_pvs && !ctx->deterministic && i > 0 && abs(bound) != SCORE_INFINITE;
+        if (scout && root->max_player) {
+            eval = alpha_beta(&worker->state, root->depth - 1, 1, alpha, alpha + 1, false);
+            if (eval > alpha && !ctx->stopped) {
+                eval = alpha_beta(&worker->state, root->depth - 1, 1, alpha, beta, false);
+            }
+        } else if (scout) {
+            eval = alpha_beta(&worker->state, root->depth - 1, 1, beta - 1, beta, true);
+            if (eval < beta && !ctx->stopped) {
+                eval = alpha_beta(&worker->state, root->depth - 1, 1, alpha, beta, true);
+            }
+        } else {
+            eval = alpha_beta(&worker->state, root->depth - 1, 1, alpha, beta, !root->max_player);
+        }
+        board_unmake_move(board, &root->moves.moves[i], &undo);
+        
+        if (ctx->stopped) {
+            break;
+        }
+        
+        // A fail high against the aspiration window is kept as well: the
+        // move is at least that good, the caller widens the window
+        bool exact = root->max_player ? (alpha == -SCORE_INFINITE || eval > alpha)
+                                      : (beta == SCORE_INFINITE || eval < beta);
+        
+        pthread_mutex_lock(&root->lock);
+        root->evals[i] = eval;
+        root->exact[i] = exact;
+        root->completed++;
+        if (exact && (root->max_player ? eval > root->bound : eval < root->bound)) {
+            root->bound = eval;
+        }
+        pthread_mutex_unlock(&root->lock);
+    }
+}
+
+static void* root_worker_thread(void *arg) {
+    root_worker_run((RootWorker*)arg);
+    return NULL;
+}
+
+// Search every root move to `depth` inside the window [alpha, beta], using
+// up to ctx->threads threads. Moves equal to `first` are searched first.
+// The best move is the first one in that order with the best value, so the
+// result does not depend on the thread count in deterministic mode. Returns
+// false if the time budget ran out before all moves were searched; a best
+// value on or outside the window is only a bound.
+static bool search_root(SearchContext *ctx, Board *board, const MoveList *moves, int depth, bool forced_capture, EvaluationFunc eval_func,
+                        Score alpha, Score beta, const Move *first, Move *best_move, Score *best_eval) {
+    RootSearch root;
+    root.moves = *moves;
+    root.depth = depth;
+    root.max_player = !board->white_to_move;
+    root.window_alpha = alpha;
+    root.window_beta = beta;
+    root.next = 0;
+    root.completed = 0;
+    root.bound = root.max_player ? alpha : beta;
+    pthread_mutex_init(&root.lock, NULL);
+    
+    if (first) {
+        for (int i = 1; i < root.moves.count; i++) {
+            if (board_moves_equal(&root.moves.moves[i], first)) {
+                Move tmp = root.moves.moves[0];
+                root.moves.moves[0] = root.moves.moves[i];
+                root.moves.moves[i] = tmp;
+                break;
+            }
+        }
+    }
+    
+    int threads = ctx->threads < root.moves.count ? ctx->threads : root.moves.count;
+    if (threads < 1) threads = 1;
+    
+    RootWorker workers[AI_MAX_THREADS];
+    pthread_t handles[AI_MAX_THREADS];
+    bool started[AI_MAX_THREADS] = {false};
+    
+    // The calling thread is worker 0 and searches the caller's board,
+    // the other workers get a copy
+    for (int t = 0; t < threads; t++) {
+        Board *worker_board = board;
+        if (t > 0) {
+            worker_board = context_thread(ctx, t) ? board_create(board->width, board->height) : NULL;
+            if (!worker_board) {
+                threads = t;
+                break;
+            }
+            board_copy(worker_board, board);
+        }
+        workers[t].root = &root;
+        search_state_init(&workers[t].state, ctx, t, worker_board, forced_capture, eval_func);
+    }
+    
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&handles[t], NULL, root_worker_thread, &workers[t]) == 0;
+    }
+    root_worker_run(&workers[0]);
+    
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(handles[t], NULL);
+        }
+        search_state_finish(&workers[t].state);
+        if (t > 0) {
+            board_free(workers[t].state.board);
+        }
+    }
+    pthread_mutex_destroy(&root.lock);
+    
+    if (root.completed < root.moves.count) {
+        return false;
+    }
+    
+    *best_move = root.moves.moves[0];
+    *best_eval = root.max_player ? -SCORE_INFINITE : SCORE_INFINITE;
+    for (int i = 0; i < root.moves.count; i++) {
+        if (root.exact[i] && (root.max_player ? root.evals[i] > *best_eval : root.evals[i] < *best_eval)) {
+            *best_eval = root.evals[i];
+            *best_move = root.moves.moves[i];
+        }
+    }
+    
+    return true;
 }
 
-// Find the best move for the current player
-Move ai_find_best_move(Board *board, int depth, bool forced_capture, EvaluationFunc eval_func) {
+// Root position in the endgame table: keep only the moves that preserve
+// its result. Returns 1 if the table also decides the move (a win or loss
+// with known distance, moved to the front of the list), 0 if the remaining
+// moves still need a search, -1 if the position is not in the table.
+static int endgame_root(const SearchContext *ctx, const Board *board, MoveList *moves, bool forced_capture, Score *score) {
+    const EndgameTable *endgame_table = ctx->endgame_table;
+    EndgameResult root;
+    if (!endgame_table || endgame_forced_capture(endgame_table) != forced_capture ||
+        !endgame_probe(endgame_table, board, &root)) {
+        return -1;
+    }
+    *score = endgame_score(board, &root, 0);
+    
+    Board child;
+    char cells[BITBOARD_WIDTH * BITBOARD_HEIGHT];
+    child.cells = cells;
+    
+    MoveList kept;
+    kept.count = 0;
+    int best = -1;
+    int best_distance = 0;
+    
+    for (int i = 0; i < moves->count; i++) {
+        EndgameResult result;
+        board_copy(&child, board);
+        board_apply_move(&child, &moves->moves[i]);
+        if (!endgame_probe(endgame_table, &child, &result)) {
+            return 0;  // incomplete table, search all moves
+        }
+        if (result.value != -root.value) {
+            continue;
+        }
+        
+        // Win: reach the shortest loss; loss: hold out the longest
+        if (best < 0 || (root.value > 0 ? result.distance < best_distance : result.distance > best_distance)) {
+            best = kept.count;
+            best_distance = result.distance;
+        }
+        kept.moves[kept.count++] = moves->moves[i];
+    }
+    
+    if (kept.count == 0) {
+        return 0;
+    }
+    
+    Move first = kept.moves[best];
+    kept.moves[best] = kept.moves[0];
+    kept.moves[0] = first;
+    *moves = kept;
+    return root.value != 0 && endgame_has_distance(endgame_table) ? 1 : 0;
+}
+
+// Add a completed iteration of the current search to the statistics
+static void record_iteration(SearchContext *ctx, int depth, Score score, unsigned long long nodes_before, double start) {
+    SearchStats *stats = &ctx->stats;
+    if (stats->iteration_count >= AI_STATS_MAX_ITERATIONS) return;
+    
+    SearchIteration *iteration = &stats->iterations[stats->iteration_count++];
+    iteration->depth = depth;
+    iteration->score = score;
+    iteration->nodes = stats->nodes - nodes_before;
+    iteration->time_ms = now_ms() - start;
+}
+
+// Find the best move for the current player (black maximizes, white minimizes)
+Move ai_find_best_move(SearchContext *ctx, Board *board, int depth, bool forced_capture, EvaluationFunc eval_func) {
+    ctx->stats.iteration_count = 0;
+    
     MoveList moves;
     board_generate_all_moves(board, forced_capture, &moves);
     
-    Move best_move = moves.moves[0];
-    double best_eval = -INFINITY;
+    Score endgame_eval;
+    int endgame = endgame_root(ctx, board, &moves, forced_capture, &endgame_eval);
+    if (endgame == 1) {
+        return moves.moves[0];
+    }
+    ctx->endgame_probing = endgame < 0;
     
-    for (int i = 0; i < moves.count; i++) {
-        Board *child = board_create(board->width, board->height);
-        board_copy(child, board);
-        board_apply_move(child, &moves.moves[i]);
+    tt_prepare(ctx, forced_capture, eval_func);
+    if (ctx->tt) {
+        tt_new_search(ctx->tt);
+    }
+    ordering_prepare(ctx);
+    
+    ctx->deadline = 0;
+    ctx->stopped = false;
+    
+    Move best_move;
+    Score best_eval;
+    unsigned long long nodes_before = ctx->stats.nodes;
+    double start = now_ms();
+    if (search_root(ctx, board, &moves, depth, forced_capture, eval_func, -SCORE_INFINITE, SCORE_INFINITE,
+                    NULL, &best_move, &best_eval)) {
+        record_iteration(ctx, depth, best_eval, nodes_before, start);
+    }
+    
+    return best_move;
+}
+
+// Aspiration windows: half width of the first window, growth factor on a
+// fail, and the width beyond which the window is opened completely. Scores
+// of decided games are not used as a window centre.
+#define ASPIRATION_WINDOW 20
+#define ASPIRATION_GROWTH 4
+#define ASPIRATION_MAX 500
+
+// Iterative deepening under a wall-clock budget
+SearchResult ai_search_timed(SearchContext *ctx, Board *board, int budget_ms, int max_depth,
+                             bool forced_capture, EvaluationFunc eval_func) {
+    SearchResult result;
+    memset(&result, 0, sizeof(SearchResult));
+    double start = now_ms();
+    ctx->stats.iteration_count = 0;
+    
+    MoveList moves;
+    board_generate_all_moves(board, forced_capture, &moves);
+    if (moves.count == 0) {
+        return result;
+    }
+    
+    int endgame = endgame_root(ctx, board, &moves, forced_capture, &result.score);
+    result.best_move = moves.moves[0];
+    if (endgame == 1) {
+        result.time_ms = now_ms() - start;
+        return result;
+    }
+    ctx->endgame_probing = endgame < 0;
+    
+    tt_prepare(ctx, forced_capture, eval_func);
+    if (ctx->tt) {
+        tt_new_search(ctx->tt);
+    }
+    ordering_prepare(ctx);
+    
+    ctx->deadline = start + budget_ms;
+    ctx->stopped = false;
+    
+    // Nothing to decide
+    if (moves.count == 1) {
+        max_depth = 0;
+    }
+    
+    for (int depth = 1; depth <= max_depth; depth++) {
+        Move best_move;
+        Score best_eval;
+        const Move *first = result.depth > 0 ? &result.best_move : NULL;
+        
+        // Aspiration window around the previous score, widened on a fail
+        // low or high until the search result lies inside it
+        Score delta = ASPIRATION_WINDOW;
+        Score alpha = -SCORE_INFINITE;
+        Score beta = SCORE_INFINITE;
+        if (ctx->use_aspiration && result.depth > 0 && !score_is_decided(result.score)) {
+            alpha = result.score - delta;
+            beta = result.score + delta;
+        }
+        
+        unsigned long long nodes_before = ctx->stats.nodes;
+        double iteration_start = now_ms();
+        bool completed;
+        while ((completed = search_root(ctx, board, &moves, depth, forced_capture, eval_func,
+                                        alpha, beta, first, &best_move, &best_eval))) {
+            if (best_eval <= alpha && alpha > -SCORE_INFINITE) {
+                delta *= ASPIRATION_GROWTH;
+                alpha = delta > ASPIRATION_MAX ? -SCORE_INFINITE : result.score - delta;
+            } else if (best_eval >= beta && beta < SCORE_INFINITE) {
+                delta *= ASPIRATION_GROWTH;
+                beta = delta > ASPIRATION_MAX ? SCORE_INFINITE : result.score + delta;
+            } else {
+                break;
+            }
+            ctx->stats.aspiration_researches++;
+        }
+        if (!completed) {
+            break;  // Out of time, keep the last completed iteration
+        }
         
-        // Assuming we're maximizing (computer is black)
-        double eval = ai_alpha_beta(child, depth - 1, -INFINITY, INFINITY, false, forced_capture, eval_func);
+        result.best_move = best_move;
+        result.score = best_eval;
+        result.depth = depth;
+        record_iteration(ctx, depth, best_eval, nodes_before, iteration_start);
         
-        board_free(child);
+        // A win or loss in n plies is final once depth n has been searched
+        // in full; before that a shorter win may still turn up
+        if (score_is_decided(best_eval) && SCORE_WIN - abs(best_eval) <= depth) {
+            break;
+        }
         
-        if (eval > best_eval) {
-            best_eval = eval;
-            best_move = moves.moves[i];
+        // The next iteration takes longer than everything so far
+        if (now_ms() - start > budget_ms / 2.0) {
+            break;
         }
     }
     
-    return best_move;
+    ctx->deadline = 0;
+    ctx->stopped = false;
+    result.time_ms = now_ms() - start;
+    
+    return result;
+}
+
+double ai_stats_branching_factor(const SearchStats *stats) {
+    int count = stats->iteration_count;
+    if (count >= 2 && stats->iterations[count - 2].nodes > 0) {
+        return (double)stats->iterations[count - 1].nodes / stats->iterations[count - 2].nodes;
+    }
+    if (count >= 1 && stats->iterations[count - 1].depth > 0) {
+        return pow((double)stats->iterations[count - 1].nodes, 1.0 / stats->iterations[count - 1].depth);
+    }
+    return 0.0;
+}
+
+void ai_write_search_stats_json(const SearchStats *stats, FILE *out) {
+    fprintf(out, "{\"nodes\": %llu, \"leaf_evals\": %llu, \"quiescence_nodes\": %llu, \"cutoffs\": %llu, "
+            "\"cutoffs_by_move\": [", stats->nodes, stats->leaf_evals, stats->quiescence_nodes, stats->cutoffs);
+    for (int i = 0; i < AI_STATS_CUTOFF_SLOTS; i++) {
+        fprintf(out, "%s%llu", i > 0 ? ", " : "", stats->cutoffs_by_move[i]);
+    }
+    fprintf(out, "], \"tt_probes\": %llu, \"tt_hits\": %llu, \"endgame_hits\": %llu, "
+            "\"aspiration_researches\": %llu, \"reductions\": %llu, \"reduction_researches\": %llu, "
+            "\"futility_pruned\": %llu, \"max_ply\": %d, \"branching_factor\": %.3f, \"iterations\": [",
+            stats->tt_probes, stats->tt_hits, stats->endgame_hits, stats->aspiration_researches,
+            stats->reductions, stats->reduction_researches, stats->futility_pruned,
+            stats->max_ply, ai_stats_branching_factor(stats));
+    for (int i = 0; i < stats->iteration_count; i++) {
+        const SearchIteration *iteration = &stats->iterations[i];
+        fprintf(out, "%s{\"depth\": %d, \"score\": %d, \"nodes\": %llu, \"time_ms\": %.3f}",
+                i > 0 ? ", " : "", iteration->depth, (int)iteration->score, iteration->nodes, iteration->time_ms);
+    }
+    fprintf(out, "]}");
+}
+
+bool ai_hash_move(const SearchContext *ctx, const Board *board, bool forced_capture, Move *move) {
+    TTEntry entry;
+    if (!ctx->tt || !tt_probe(ctx->tt, board->hash, &entry) || entry.best_from == TT_NO_MOVE) {
+        return false;
+    }
+    
+    MoveList moves;
+    board_generate_all_moves(board, forced_capture, &moves);
+    for (int i = 0; i < moves.count; i++) {
+        const Move *candidate = &moves.moves[i];
+        if (board_index(board, candidate->from.row, candidate->from.col) == entry.best_from &&
+            board_index(board, candidate->to.row, candidate->to.col) == entry.best_to) {
+            *move = *candidate;
+            return true;
+        }
+    }
+    return false;
 }
 
 // Dynamic depth adjustment based on game state
@@ -2,19 +2,182 @@
 #define AI_H
 
 #include "board.h"
+#include "endgame.h"
+#include "tt.h"
+#include "ordering.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
-// Evaluation function pointer type
-typedef double (*EvaluationFunc)(const Board *board);
+#define AI_MAX_THREADS 64
+#define AI_DEFAULT_QUIESCENCE_DEPTH 8
+
+// Scores are integers from black's point of view (black maximizes).
+// A won game scores SCORE_WIN minus the plies it takes, so faster wins and
+// slower losses are preferred; anything beyond SCORE_DECIDED is such a win
+// or loss. SCORE_INFINITE bounds the search window.
+typedef int32_t Score;
+
+#define SCORE_INFINITE 1000000
+#define SCORE_WIN 100000
+#define SCORE_DECIDED (SCORE_WIN - 1000)
+
+static inline bool score_is_decided(Score score) {
+    return score >= SCORE_DECIDED || score <= -SCORE_DECIDED;
+}
+
+// Evaluation function pointer type. A side without pieces has lost:
+// evaluations return +-SCORE_WIN for it, the search adds the distance.
+typedef Score (*EvaluationFunc)(const Board *board);
 
 // Default evaluation functions
-double evaluate_standard(const Board *board);
-double evaluate_ending(const Board *board);
+Score evaluate_standard(const Board *board);
+Score evaluate_ending(const Board *board);
+
+// The game's choice for `board`: evaluate_standard while more than
+// AI_ENDING_PIECES pieces are left, evaluate_ending from then on
+#define AI_ENDING_PIECES 6
+EvaluationFunc ai_default_evaluation(const Board *board);
+
+// Settings, time control, statistics and per-thread memory (move stacks,
+// killer and history tables) of the alpha-beta searches. A context runs
+// one search at a time; separate contexts can search concurrently, also
+// sharing a transposition table. Killers and history carry over from one
+// search to the next.
+typedef struct SearchContext SearchContext;
+
+SearchContext* ai_context_create(void);
+void ai_context_free(SearchContext *ctx);
 
 // AI algorithms (decoupled from game logic)
-double ai_minimax(Board *board, int depth, bool max_player, EvaluationFunc eval_func);
-double ai_alpha_beta(Board *board, int depth, double alpha, double beta, bool max_player, bool forced_capture, EvaluationFunc eval_func);
-Move ai_find_best_move(Board *board, int depth, bool forced_capture, EvaluationFunc eval_func);
+// They search in place with board_make_move/board_unmake_move and leave `board` unchanged
+Score ai_minimax(Board *board, int depth, bool max_player, EvaluationFunc eval_func);
+Score ai_alpha_beta(SearchContext *ctx, Board *board, int depth, Score alpha, Score beta, bool max_player,
+                    bool forced_capture, EvaluationFunc eval_func);
+Move ai_find_best_move(SearchContext *ctx, Board *board, int depth, bool forced_capture, EvaluationFunc eval_func);
+
+// Transposition table used by ai_alpha_beta and ai_find_best_move (NULL disables it).
+// The caller keeps ownership; the table is cleared when the evaluation function
+// or the capture rule changes between searches.
+void ai_set_transposition_table(SearchContext *ctx, TranspositionTable *tt);
+
+// Parallel search: root moves of ai_find_best_move and ai_search_timed are
+// spread over `threads` threads (1 = serial) sharing the transposition table.
+void ai_set_threads(SearchContext *ctx, int threads);
+// In deterministic mode every root move gets a full window, table entries
+// are only used at their exact depth and late move reductions are off, so
+// the chosen move at a fixed depth is the same for any thread count. Off by
+// default (faster, ties may differ).
+void ai_set_deterministic(SearchContext *ctx, bool deterministic);
+
+// Killer moves, history heuristic and hash move first (on by default)
+void ai_set_move_ordering(SearchContext *ctx, bool enabled);
+bool ai_get_move_ordering(const SearchContext *ctx);
+// Forget killers and history, e.g. before a new game
+void ai_clear_move_ordering(SearchContext *ctx);
+
+// Captures searched past the nominal depth, at most `plies` (0 disables)
+void ai_set_quiescence_depth(SearchContext *ctx, int plies);
+
+// Principal variation search: moves after the first are searched with a
+// null window and re-searched only if they beat it (on by default)
+void ai_set_pvs(SearchContext *ctx, bool enabled);
+bool ai_get_pvs(const SearchContext *ctx);
+// Aspiration windows around the previous iteration's score in
+// ai_search_timed (on by default)
+void ai_set_aspiration(SearchContext *ctx, bool enabled);
+bool ai_get_aspiration(const SearchContext *ctx);
+
+// Late move reductions: quiet moves late in the ordering are searched one
+// or two plies shallower with a null window, and again at full depth if
+// they beat it (on by default, skipped in deterministic mode)
+void ai_set_lmr(SearchContext *ctx, bool enabled);
+bool ai_get_lmr(const SearchContext *ctx);
+// Futility pruning: one ply above the horizon, quiet moves after the first
+// are skipped when the static evaluation is so far below the window that a
+// quiet move plus a won man cannot reach it. Only for evaluate_standard and
+// evaluate_ending, whose piece-square tables give the margin (off by default)
+void ai_set_futility(SearchContext *ctx, bool enabled);
+bool ai_get_futility(const SearchContext *ctx);
+
+// Endgame table probed by the searches (NULL disables it). Only used when
+// it was generated for the same capture rule as the search.
+void ai_set_endgame_table(SearchContext *ctx, const EndgameTable *table);
+
+// Startup of the headless modes: loads the tuned evaluation of
+// BOARD_EVAL_FILE if there is one, before any board is set up since boards
+// build their incremental evaluation from it, and maps ENDGAME_FILE (NULL
+// without it, released with endgame_close)
+EndgameTable* ai_load_tables(void);
+
+// Flag polled by the searches next to the clock: once another thread sets
+// it, ai_search_timed returns its last completed iteration. The caller
+// clears it before starting a search (NULL disables it).
+void ai_set_abort_flag(SearchContext *ctx, const volatile bool *flag);
+
+#define AI_STATS_CUTOFF_SLOTS 8
+#define AI_STATS_MAX_ITERATIONS 64
+
+// One iteration of iterative deepening
+typedef struct SearchIteration {
+    int depth;
+    Score score;
+    unsigned long long nodes;   // aspiration re-searches included
+    double time_ms;             // this iteration alone
+} SearchIteration;
+
+// Counters accumulated over all searches since the last reset
+typedef struct SearchStats {
+    unsigned long long nodes;
+    unsigned long long leaf_evals;          // static evaluations
+    unsigned long long quiescence_nodes;    // capture-only nodes below the horizon
+    unsigned long long cutoffs;             // beta/alpha cutoffs in interior nodes
+    // Cutoffs by the position of the move that caused them in search order
+    // (0 = first move); the last slot also counts all later moves
+    unsigned long long cutoffs_by_move[AI_STATS_CUTOFF_SLOTS];
+    unsigned long long tt_probes;
+    unsigned long long tt_hits;             // probes that found the position
+    unsigned long long endgame_hits;        // nodes scored by the endgame table
+    unsigned long long aspiration_researches;  // root searches repeated with a wider window
+    unsigned long long reductions;          // moves searched with late move reductions
+    unsigned long long reduction_researches;   // reduced moves searched again at full depth
+    unsigned long long futility_pruned;     // moves skipped by futility pruning
+    int max_ply;                            // deepest ply reached, quiescence included
+    
+    // Iterations of the latest ai_search_timed (ai_find_best_move counts
+    // as a single iteration); the first AI_STATS_MAX_ITERATIONS are kept
+    int iteration_count;
+    SearchIteration iterations[AI_STATS_MAX_ITERATIONS];
+} SearchStats;
+
+void ai_get_search_stats(const SearchContext *ctx, SearchStats *stats);
+void ai_reset_search_stats(SearchContext *ctx);
+
+// Effective branching factor of the latest search: nodes of its last
+// iteration over the one before, or the depth-th root of the nodes of a
+// single iteration. 0 without iterations.
+double ai_stats_branching_factor(const SearchStats *stats);
+
+// The counters as one JSON object on a single line, without a newline
+void ai_write_search_stats_json(const SearchStats *stats, FILE *out);
+
+// Result of a timed search
+typedef struct SearchResult {
+    Move best_move;
+    Score score;
+    int depth;           // deepest fully searched iteration, 0 if none finished
+    double time_ms;
+} SearchResult;
+
+// Iterative deepening: searches depth 1, 2, ... up to max_depth, trying the
+// previous iteration's best move first, and stops when budget_ms of wall-clock
+// time (monotonic clock) is used up. Returns the last completed iteration.
+SearchResult ai_search_timed(SearchContext *ctx, Board *board, int budget_ms, int max_depth,
+                             bool forced_capture, EvaluationFunc eval_func);
+
+// Legal move stored for `board` in the transposition table, e.g. the reply
+// the last search expects from the opponent. False if there is none.
+bool ai_hash_move(const SearchContext *ctx, const Board *board, bool forced_capture, Move *move);
 
 // Helper for dynamic depth adjustment
 int ai_determine_dynamic_depth(double time_previous_move, int depth, bool forced_capture, int num_moves);
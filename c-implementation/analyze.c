@@ -0,0 +1,375 @@
+#define _POSIX_C_SOURCE 200809L  // fork, poll, sysconf
+
+#include "analyze.h"
+#include "ai.h"
+#include "fen.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+#define ANALYZE_MAX_WORKERS 256
+#define ANALYZE_ID_LENGTH 64
+#define ANALYZE_LINE_LENGTH 512
+
+typedef struct AnalyzeOptions {
+    const char *input;      // NULL reads stdin
+    int time_ms;            // budget per position
+    int max_depth;
+    int workers;
+    int tt_size_mb;         // per worker
+    bool forced_capture;
+    bool stats;             // add the search statistics to every result
+    const EndgameTable *endgame;  // mapped once, shared by the workers
+} AnalyzeOptions;
+
+// Fixed-size messages on the worker pipes, small enough to be written
+// atomically (PIPE_BUF)
+typedef struct AnalyzeJob {
+    int line;
+    bool overlong;          // fen was cut to fit, never a valid position
+    char fen[FEN_MAX_LENGTH];
+    char id[ANALYZE_ID_LENGTH];
+} AnalyzeJob;
+
+typedef struct AnalyzeResult {
+    AnalyzeJob job;
+    bool valid;             // the position parsed
+    bool has_move;          // false if the side to move has no move
+    char move[MOVE_TEXT_LENGTH];
+    Score score;
+    int depth;
+    double time_ms;
+    SearchStats stats;
+} AnalyzeResult;
+
+typedef struct Worker {
+    pid_t pid;
+    int jobs;               // write end, parent to worker
+    int results;            // read end, worker to parent
+    bool busy;
+} Worker;
+
+static bool write_full(int fd, const void *data, size_t size) {
+    const char *bytes = (const char*)data;
+    while (size > 0) {
+        ssize_t n = write(fd, bytes, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// False at end of file
+static bool read_full(int fd, void *data, size_t size) {
+    char *bytes = (char*)data;
+    while (size > 0) {
+        ssize_t n = read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void analyze_position(SearchContext *ctx, Board *board, const AnalyzeOptions *options, AnalyzeResult *result) {
+    result->valid = !result->job.overlong && fen_parse(board, result->job.fen);
+    if (!result->valid) return;
+    
+    ai_reset_search_stats(ctx);
+    SearchResult search = ai_search_timed(ctx, board, options->time_ms, options->max_depth,
+                                          options->forced_capture, ai_default_evaluation(board));
+    ai_get_search_stats(ctx, &result->stats);
+    
+    result->has_move = board_has_moves(board);
+    if (result->has_move) {
+        fen_format_move(board, &search.best_move, result->move, sizeof(result->move));
+        result->score = search.score;
+    } else {
+        result->score = board->white_to_move ? SCORE_WIN : -SCORE_WIN;
+    }
+    result->depth = search.depth;
+    result->time_ms = search.time_ms;
+}
+
+// Worker process: answer jobs until the parent closes the pipe
+static void worker_run(int jobs, int results, const AnalyzeOptions *options) {
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    SearchContext *ctx = ai_context_create();
+    TranspositionTable *tt = options->tt_size_mb > 0 ? tt_create(options->tt_size_mb) : NULL;
+    
+    if (board && ctx) {
+        ai_set_transposition_table(ctx, tt);
+        ai_set_endgame_table(ctx, options->endgame);
+        
+        AnalyzeResult result;
+        while (read_full(jobs, &result.job, sizeof(AnalyzeJob))) {
+            analyze_position(ctx, board, options, &result);
+            if (!write_full(results, &result, sizeof(result))) break;
+        }
+    }
+    
+    ai_context_free(ctx);
+    tt_free(tt);
+    board_free(board);
+}
+
+static void print_json_string(const char *text) {
+    putchar('"');
+    for (const unsigned char *c = (const unsigned char*)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            printf("\\%c", *c);
+        } else if (*c < 0x20) {
+            printf("\\u%04x", *c);
+        } else {
+            putchar(*c);
+        }
+    }
+    putchar('"');
+}
+
+static void print_result(const AnalyzeResult *result, const AnalyzeOptions *options) {
+    printf("{\"line\": %d, ", result->job.line);
+    if (result->job.id[0]) {
+        printf("\"id\": ");
+        print_json_string(result->job.id);
+        printf(", ");
+    }
+    printf("\"fen\": ");
+    print_json_string(result->job.fen);
+    
+    if (!result->valid) {
+        printf(", \"error\": \"invalid position\"}\n");
+    } else {
+        printf(", \"move\": ");
+        if (result->has_move) {
+            print_json_string(result->move);
+        } else {
+            printf("null");
+        }
+        printf(", \"score\": %d, \"depth\": %d, \"nodes\": %llu, \"time_ms\": %.1f",
+               (int)result->score, result->depth, result->stats.nodes, result->time_ms);
+        if (options->stats) {
+            printf(", \"stats\": ");
+            ai_write_search_stats_json(&result->stats, stdout);
+        }
+        printf("}\n");
+    }
+    fflush(stdout);
+}
+
+// Start the workers; each child only keeps its own two pipe ends
+static int start_workers(Worker *workers, const AnalyzeOptions *options) {
+    fflush(stdout);
+    
+    int started = 0;
+    for (int w = 0; w < options->workers; w++) {
+        int jobs[2], results[2];
+        if (pipe(jobs) != 0) break;
+        if (pipe(results) != 0) {
+            close(jobs[0]);
+            close(jobs[1]);
+            break;
+        }
+        
+        pid_t pid = fork();
+        if (pid == 0) {
+            for (int other = 0; other < started; other++) {
+                close(workers[other].jobs);
+                close(workers[other].results);
+            }
+            close(jobs[1]);
+            close(results[0]);
+            worker_run(jobs[0], results[1], options);
+            _exit(0);
+        }
+        
+        close(jobs[0]);
+        close(results[1]);
+        if (pid < 0) {
+            close(jobs[1]);
+            close(results[0]);
+            break;
+        }
+        workers[started++] = (Worker){pid, jobs[1], results[0], false};
+    }
+    return started;
+}
+
+// Wait for at least one busy worker to finish and print its results.
+// Returns false if a worker died.
+static bool collect_results(Worker *workers, int count, const AnalyzeOptions *options) {
+    struct pollfd fds[ANALYZE_MAX_WORKERS];
+    int index[ANALYZE_MAX_WORKERS];
+    int waiting = 0;
+    
+    for (int w = 0; w < count; w++) {
+        if (workers[w].busy) {
+            fds[waiting] = (struct pollfd){workers[w].results, POLLIN, 0};
+            index[waiting++] = w;
+        }
+    }
+    if (waiting == 0) return true;
+    
+    while (poll(fds, (nfds_t)waiting, -1) < 0) {
+        if (errno != EINTR) return false;
+    }
+    
+    for (int i = 0; i < waiting; i++) {
+        if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        
+        AnalyzeResult result;
+        if (!read_full(fds[i].fd, &result, sizeof(result))) {
+            fprintf(stderr, "Worker %d stopped unexpectedly\n", index[i]);
+            return false;
+        }
+        print_result(&result, options);
+        workers[index[i]].busy = false;
+    }
+    return true;
+}
+
+// Parse "<fen> [id]", false for blank and comment lines
+static bool parse_line(const char *line, int line_number, AnalyzeJob *job) {
+    char fen[ANALYZE_LINE_LENGTH];
+    char id[ANALYZE_LINE_LENGTH] = "";
+    if (line[0] == '#' || sscanf(line, "%511s %511s", fen, id) < 1) {
+        return false;
+    }
+    
+    memset(job, 0, sizeof(AnalyzeJob));
+    job->line = line_number;
+    job->overlong = strlen(fen) >= sizeof(job->fen);
+    memcpy(job->fen, fen, job->overlong ? sizeof(job->fen) - 1 : strlen(fen));
+    memcpy(job->id, id, strlen(id) < sizeof(job->id) ? strlen(id) : sizeof(job->id) - 1);
+    return true;
+}
+
+static void print_usage(void) {
+    fprintf(stderr,
+            "Usage: checkers --analyze [FILE] [options]\n"
+            "  FILE             positions, one \"<fen> [id]\" per line (default: stdin)\n"
+            "  --time MS        search budget per position (default 1000)\n"
+            "  --depth N        maximum depth (default 64)\n"
+            "  --workers N      worker processes (default: one per core)\n"
+            "  --tt MB          transposition table per worker, 0 disables it (default 16)\n"
+            "  --no-forced      captures are optional\n"
+            "  --stats          add the search statistics to every result\n");
+}
+
+static bool parse_options(int argc, char *argv[], AnalyzeOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (strcmp(arg, "--time") == 0 && has_value) {
+            options->time_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--depth") == 0 && has_value) {
+            options->max_depth = atoi(argv[++i]);
+        } else if (strcmp(arg, "--workers") == 0 && has_value) {
+            options->workers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--tt") == 0 && has_value) {
+            options->tt_size_mb = atoi(argv[++i]);
+        } else if (strcmp(arg, "--no-forced") == 0) {
+            options->forced_capture = false;
+        } else if (strcmp(arg, "--stats") == 0) {
+            options->stats = true;
+        } else if (arg[0] != '-' && !options->input) {
+            options->input = arg;
+        } else if (strcmp(arg, "-") == 0 && !options->input) {
+            options->input = NULL;
+        } else {
+            print_usage();
+            return false;
+        }
+    }
+    
+    if (options->time_ms < 1 || options->max_depth < 1) {
+        print_usage();
+        return false;
+    }
+    if (options->workers < 1) options->workers = 1;
+    if (options->workers > ANALYZE_MAX_WORKERS) options->workers = ANALYZE_MAX_WORKERS;
+    return true;
+}
+
+int analyze_main(int argc, char *argv[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    AnalyzeOptions options = {NULL, 1000, 64, cores > 0 ? (int)cores : 1, 16, true, false, NULL};
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+    
+    FILE *input = options.input ? fopen(options.input, "r") : stdin;
+    if (!input) {
+        fprintf(stderr, "Cannot open %s\n", options.input);
+        return 1;
+    }
+    
+    // A worker that dies shows up as a failed write, not a signal
+    signal(SIGPIPE, SIG_IGN);
+    
+    // Shared by all workers: tuned evaluation and the mapped endgame table
+    EndgameTable *endgame = ai_load_tables();
+    options.endgame = endgame;
+    
+    Worker workers[ANALYZE_MAX_WORKERS];
+    int count = start_workers(workers, &options);
+    if (count == 0) {
+        fprintf(stderr, "Cannot start workers\n");
+        return 1;
+    }
+    
+    char line[ANALYZE_LINE_LENGTH];
+    int line_number = 0;
+    bool ok = true;
+    
+    while (ok && fgets(line, sizeof(line), input)) {
+        line_number++;
+        AnalyzeJob job;
+        if (!parse_line(line, line_number, &job)) continue;
+        
+        int idle = -1;
+        while (ok && idle < 0) {
+            for (int w = 0; w < count && idle < 0; w++) {
+                if (!workers[w].busy) idle = w;
+            }
+            if (idle < 0) {
+                ok = collect_results(workers, count, &options);
+            }
+        }
+        if (ok) {
+            ok = write_full(workers[idle].jobs, &job, sizeof(job));
+            workers[idle].busy = true;
+        }
+    }
+    
+    // Drain the pool, then let the workers exit
+    bool busy = true;
+    while (ok && busy) {
+        ok = collect_results(workers, count, &options);
+        busy = false;
+        for (int w = 0; w < count; w++) {
+            busy = busy || workers[w].busy;
+        }
+    }
+    for (int w = 0; w < count; w++) {
+        close(workers[w].jobs);
+        close(workers[w].results);
+        waitpid(workers[w].pid, NULL, 0);
+    }
+    
+    if (input != stdin) fclose(input);
+    endgame_close(endgame);
+    return ok ? 0 : 1;
+}
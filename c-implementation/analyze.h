@@ -0,0 +1,22 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+// Headless batch analysis (`checkers --analyze`): positions are read one
+// per line as "<fen> [id]" from a file or stdin, searched by a pool of
+// worker processes, and every result is written to stdout as one JSON
+// line as soon as it is ready:
+//
+//   {"line": 3, "id": "g12", "fen": "B:W21,...", "move": "11-15",
+//    "score": 35, "depth": 14, "nodes": 1234567, "time_ms": 1000.2}
+//
+// Results come in completion order; "line" is the input line number.
+// Scores are from black's point of view like the engine's (see ai.h). A
+// position with a single legal move is not searched (depth 0), one without
+// moves has "move": null and the loss score. Invalid positions get an
+// "error" field instead of a move. With --stats every result also has a
+// "stats" object with the search counters of ai.h (ai_write_search_stats_json).
+
+// argv[0] is "--analyze"; returns the process exit status
+int analyze_main(int argc, char *argv[]);
+
+#endif
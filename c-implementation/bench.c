@@ -0,0 +1,642 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, sysconf
+
+#include "board.h"
+#include "bitboard.h"
+#include "cells.h"
+#include "ai.h"
+#include "fen.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Heap accounting: the bench target links with -Wl,--wrap=<fn> so every
+// allocation made by the engine objects goes through these counters.
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+static long allocations = 0;
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocations++;
+    return __real_realloc(ptr, size);
+}
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+
+#define DEFAULT_SUITE "bench_suite.txt"
+#define MAX_SUITE 64
+#define SUITE_NAME_LENGTH 32
+
+// Position suite loaded from a text file, see bench_suite.txt
+typedef struct SuitePosition {
+    char fen[FEN_MAX_LENGTH];
+    char name[SUITE_NAME_LENGTH];
+} SuitePosition;
+
+static SuitePosition suite[MAX_SUITE];
+static int suite_size = 0;
+
+// Context of every benchmarked search, created in main
+static SearchContext *search_ctx = NULL;
+
+// Search switches that can be compared off/on
+typedef struct BenchSwitch {
+    const char *name;
+    const char *title;
+    void (*set)(SearchContext *ctx, bool enabled);
+    bool (*get)(const SearchContext *ctx);
+    bool selective;     // report reductions and pruning, not aspiration re-searches
+} BenchSwitch;
+
+static const BenchSwitch switches[] = {
+    {"ordering", "Move ordering", ai_set_move_ordering, ai_get_move_ordering, false},
+    {"pvs", "Principal variation search", ai_set_pvs, ai_get_pvs, false},
+    {"aspiration", "Aspiration windows", ai_set_aspiration, ai_get_aspiration, false},
+    {"lmr", "Late move reductions", ai_set_lmr, ai_get_lmr, true},
+    {"futility", "Futility pruning", ai_set_futility, ai_get_futility, true},
+};
+
+#define SWITCH_COUNT (int)(sizeof(switches) / sizeof(switches[0]))
+
+typedef struct BenchOptions {
+    const char *suite_file;
+    const char *eval_file;  // piece-square tables, NULL for the built-in ones
+    int depth;           // fixed-depth search of every position
+    int time_ms;         // timed search of every position, 0 skips it
+    int tt_size_mb;
+    int threads;
+    int scaling_threads; // thread scaling report up to this count, 0 skips it
+    bool counting;       // cell counting paths report
+    bool compare[SWITCH_COUNT];  // off/on report of each search switch
+    bool json;
+} BenchOptions;
+
+// Result of one search of one position
+typedef struct BenchResult {
+    char move[MOVE_TEXT_LENGTH];
+    int depth;
+    double ms;
+    unsigned long long nodes;
+    long allocations;
+    double tt_hit_rate;
+} BenchResult;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static double nodes_per_second(const BenchResult *result) {
+    return result->ms > 0 ? result->nodes * 1000.0 / result->ms : 0.0;
+}
+
+// Lines are "<fen> [name]"; blank lines and lines starting with # are skipped
+static bool load_suite(const char *path, Board *board) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open suite %s\n", path);
+        return false;
+    }
+    
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) && suite_size < MAX_SUITE) {
+        line_number++;
+        char fen[FEN_MAX_LENGTH];
+        char name[SUITE_NAME_LENGTH] = "";
+        if (line[0] == '#' || sscanf(line, "%159s %31s", fen, name) < 1) continue;
+        
+        if (!fen_parse(board, fen)) {
+            fprintf(stderr, "%s:%d: invalid position '%s'\n", path, line_number, fen);
+            fclose(file);
+            return false;
+        }
+        
+        SuitePosition *position = &suite[suite_size++];
+        strcpy(position->fen, fen);
+        if (name[0]) {
+            strcpy(position->name, name);
+        } else {
+            snprintf(position->name, sizeof(position->name), "position-%d", suite_size);
+        }
+    }
+    
+    fclose(file);
+    if (suite_size == 0) {
+        fprintf(stderr, "Suite %s has no positions\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Clear the table, move ordering and counters so every search starts from
+// the same state. The engine clears the table itself when the evaluation
+// changes; a depth 1 search lets that happen outside the timed region.
+static void reset_search(Board *board, EvaluationFunc eval_func, TranspositionTable *tt) {
+    ai_find_best_move(search_ctx, board, 1, false, eval_func);
+    ai_clear_move_ordering(search_ctx);
+    if (tt) {
+        tt_clear(tt);
+        tt_reset_stats(tt);
+    }
+    ai_reset_search_stats(search_ctx);
+    allocations = 0;
+}
+
+static void finish_result(BenchResult *result, const Board *board, const Move *move, double start, TranspositionTable *tt) {
+    result->ms = now_ms() - start;
+    result->allocations = allocations;
+    
+    SearchStats stats;
+    ai_get_search_stats(search_ctx, &stats);
+    result->nodes = stats.nodes;
+    
+    TTStats tt_stats = {0};
+    if (tt) {
+        tt_get_stats(tt, &tt_stats);
+    }
+    result->tt_hit_rate = tt_stats.hit_rate;
+    fen_format_move(board, move, result->move, sizeof(result->move));
+}
+
+static void search_fixed(Board *board, int depth, TranspositionTable *tt, BenchResult *result) {
+    EvaluationFunc eval_func = ai_default_evaluation(board);
+    reset_search(board, eval_func, tt);
+    double start = now_ms();
+    Move best_move = ai_find_best_move(search_ctx, board, depth, false, eval_func);
+    result->depth = depth;
+    finish_result(result, board, &best_move, start, tt);
+}
+
+static void search_timed(Board *board, int budget_ms, TranspositionTable *tt, BenchResult *result) {
+    EvaluationFunc eval_func = ai_default_evaluation(board);
+    reset_search(board, eval_func, tt);
+    double start = now_ms();
+    SearchResult search = ai_search_timed(search_ctx, board, budget_ms, 128, false, eval_func);
+    result->depth = search.depth;
+    finish_result(result, board, &search.best_move, start, tt);
+}
+
+static void print_result_json(const char *key, const BenchResult *result) {
+    printf("\"%s\": {\"depth\": %d, \"move\": \"%s\", \"nodes\": %llu, \"ms\": %.3f, "
+           "\"nps\": %.0f, \"allocations\": %ld, \"tt_hit_rate\": %.4f}",
+           key, result->depth, result->move, result->nodes, result->ms,
+           nodes_per_second(result), result->allocations, result->tt_hit_rate);
+}
+
+// Fixed-depth and timed search of every suite position. Time to depth is
+// measured by searching depth 1, 2, ... N from an empty table each time.
+static void bench_suite(Board *board, const BenchOptions *options, TranspositionTable *tt) {
+    BenchResult fixed_total = {{0}, options->depth, 0, 0, 0, 0};
+    BenchResult timed_total = {{0}, 0, 0, 0, 0, 0};
+    
+    if (options->json) {
+        printf("  \"positions\": [\n");
+    } else {
+        printf("Suite %s: %d positions, depth %d, %d ms budget, %d thread(s)\n\n",
+               options->suite_file, suite_size, options->depth, options->time_ms, options->threads);
+        printf("%-20s %-10s %-12s %-10s %-12s %-8s %-12s %-6s %s\n", "position", "move", "nodes",
+               "ms", "nps", "allocs", "timed move", "depth", "timed nps");
+    }
+    
+    for (int i = 0; i < suite_size; i++) {
+        fen_parse(board, suite[i].fen);
+        
+        double time_to_depth[128];
+        BenchResult fixed;
+        for (int depth = 1; depth <= options->depth; depth++) {
+            search_fixed(board, depth, tt, &fixed);
+            time_to_depth[depth - 1] = fixed.ms;
+        }
+        
+        BenchResult timed = {{0}, 0, 0, 0, 0, 0};
+        if (options->time_ms > 0) {
+            search_timed(board, options->time_ms, tt, &timed);
+        }
+        
+        fixed_total.nodes += fixed.nodes;
+        fixed_total.ms += fixed.ms;
+        fixed_total.allocations += fixed.allocations;
+        timed_total.nodes += timed.nodes;
+        timed_total.ms += timed.ms;
+        timed_total.depth += timed.depth;
+        
+        if (options->json) {
+            printf("    {\"name\": \"%s\", \"fen\": \"%s\", ", suite[i].name, suite[i].fen);
+            print_result_json("fixed", &fixed);
+            printf(", \"time_to_depth_ms\": [");
+            for (int depth = 1; depth <= options->depth; depth++) {
+                printf("%s%.3f", depth > 1 ? ", " : "", time_to_depth[depth - 1]);
+            }
+            printf("]");
+            if (options->time_ms > 0) {
+                printf(", ");
+                print_result_json("timed", &timed);
+            }
+            printf("}%s\n", i + 1 < suite_size ? "," : "");
+        } else {
+            printf("%-20s %-10s %-12llu %-10.1f %-12.0f %-8ld %-12s %-6d %.0f\n", suite[i].name,
+                   fixed.move, fixed.nodes, fixed.ms, nodes_per_second(&fixed), fixed.allocations,
+                   timed.move, timed.depth, nodes_per_second(&timed));
+        }
+    }
+    
+    if (options->json) {
+        printf("  ],\n  \"total\": {\"fixed_nodes\": %llu, \"fixed_ms\": %.3f, \"fixed_nps\": %.0f, "
+               "\"allocations\": %ld, \"timed_nodes\": %llu, \"timed_nps\": %.0f, \"timed_mean_depth\": %.2f}",
+               fixed_total.nodes, fixed_total.ms, nodes_per_second(&fixed_total), fixed_total.allocations,
+               timed_total.nodes, nodes_per_second(&timed_total), (double)timed_total.depth / suite_size);
+    } else {
+        printf("%-20s %-10s %-12llu %-10.1f %-12.0f %-8ld %-12s %-6.1f %.0f\n", "total", "",
+               fixed_total.nodes, fixed_total.ms, nodes_per_second(&fixed_total), fixed_total.allocations,
+               "", (double)timed_total.depth / suite_size, nodes_per_second(&timed_total));
+    }
+}
+
+// Nodes and first-move cutoff rate over the suite with one search feature
+// off and on, searching by iterative deepening up to the bench depth
+static void bench_switch(Board *board, const BenchOptions *options, TranspositionTable *tt, const BenchSwitch *feature) {
+    if (options->json) {
+        printf(",\n  \"%s\": [", feature->name);
+    } else {
+        printf("\n%s, iterative deepening to depth %d\n", feature->title, options->depth);
+        if (feature->selective) {
+            printf("%-10s %-12s %-10s %-18s %-12s %-10s %-10s %s\n", feature->name, "nodes", "cutoffs",
+                   "first-move cutoffs", "reductions", "re-search", "pruned", "ms");
+        } else {
+            printf("%-10s %-12s %-10s %-18s %-10s %s\n", feature->name, "nodes", "cutoffs",
+                   "first-move cutoffs", "re-search", "ms");
+        }
+    }
+    
+    bool saved = feature->get(search_ctx);
+    for (int enabled = 0; enabled <= 1; enabled++) {
+        feature->set(search_ctx, enabled);
+        SearchStats total = {0};
+        double total_ms = 0;
+        
+        for (int i = 0; i < suite_size; i++) {
+            fen_parse(board, suite[i].fen);
+            EvaluationFunc eval_func = ai_default_evaluation(board);
+            reset_search(board, eval_func, tt);
+            
+            double start = now_ms();
+            ai_search_timed(search_ctx, board, INT_MAX, options->depth, false, eval_func);
+            total_ms += now_ms() - start;
+            
+            SearchStats stats;
+            ai_get_search_stats(search_ctx, &stats);
+            total.nodes += stats.nodes;
+            total.cutoffs += stats.cutoffs;
+            total.cutoffs_by_move[0] += stats.cutoffs_by_move[0];
+            total.aspiration_researches += stats.aspiration_researches;
+            total.reductions += stats.reductions;
+            total.reduction_researches += stats.reduction_researches;
+            total.futility_pruned += stats.futility_pruned;
+        }
+        
+        double first_rate = total.cutoffs ? (double)total.cutoffs_by_move[0] / total.cutoffs : 0.0;
+        if (options->json) {
+            printf("%s{\"enabled\": %s, \"nodes\": %llu, \"cutoffs\": %llu, \"first_move_cutoff_rate\": %.4f, ",
+                   enabled ? ", " : "", enabled ? "true" : "false", total.nodes, total.cutoffs, first_rate);
+            if (feature->selective) {
+                printf("\"reductions\": %llu, \"reduction_researches\": %llu, \"futility_pruned\": %llu, ",
+                       total.reductions, total.reduction_researches, total.futility_pruned);
+            } else {
+                printf("\"aspiration_researches\": %llu, ", total.aspiration_researches);
+            }
+            printf("\"ms\": %.3f}", total_ms);
+        } else if (feature->selective) {
+            printf("%-10s %-12llu %-10llu %-18.1f %-12llu %-10llu %-10llu %.1f\n", enabled ? "on" : "off",
+                   total.nodes, total.cutoffs, 100.0 * first_rate, total.reductions,
+                   total.reduction_researches, total.futility_pruned, total_ms);
+        } else {
+            printf("%-10s %-12llu %-10llu %-18.1f %-10llu %.1f\n", enabled ? "on" : "off",
+                   total.nodes, total.cutoffs, 100.0 * first_rate, total.aspiration_researches, total_ms);
+        }
+    }
+    feature->set(search_ctx, saved);
+    
+    if (options->json) {
+        printf("]");
+    }
+}
+
+// Fixed-depth searches of every suite position, the chosen moves go to
+// `moves`; returns the total wall-clock time
+static double search_suite(Board *board, int depth, TranspositionTable *tt, char (*moves)[MOVE_TEXT_LENGTH]) {
+    double ms = 0;
+    for (int i = 0; i < suite_size; i++) {
+        BenchResult result;
+        fen_parse(board, suite[i].fen);
+        search_fixed(board, depth, tt, &result);
+        snprintf(moves[i], MOVE_TEXT_LENGTH, "%s", result.move);
+        ms += result.ms;
+    }
+    return ms;
+}
+
+// Speedup of the parallel root search over the serial one on the suite, in
+// deterministic mode (every position must pick the serial move) and by default
+static void bench_threads(Board *board, const BenchOptions *options, TranspositionTable *tt) {
+    int max_threads = options->scaling_threads;
+    
+    if (options->json) {
+        printf(",\n  \"scaling\": [");
+    } else {
+        printf("\nParallel search, %d positions, depth %d\n", suite_size, options->depth);
+        printf("%-8s %-14s %-10s %-11s %-14s %-10s\n", "threads", "deterministic", "speedup", "mismatches", "default", "speedup");
+    }
+    
+    static char serial_moves[MAX_SUITE][MOVE_TEXT_LENGTH];
+    static char moves[MAX_SUITE][MOVE_TEXT_LENGTH];
+    ai_set_threads(search_ctx, 1);
+    ai_set_deterministic(search_ctx, true);
+    double serial_det = search_suite(board, options->depth, tt, serial_moves);
+    ai_set_deterministic(search_ctx, false);
+    double serial_fast = search_suite(board, options->depth, tt, moves);
+    
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        ai_set_threads(search_ctx, threads);
+        ai_set_deterministic(search_ctx, true);
+        double det = search_suite(board, options->depth, tt, moves);
+        int mismatches = 0;
+        for (int i = 0; i < suite_size; i++) {
+            if (strcmp(moves[i], serial_moves[i]) != 0) mismatches++;
+        }
+        ai_set_deterministic(search_ctx, false);
+        double fast = search_suite(board, options->depth, tt, moves);
+        
+        if (options->json) {
+            printf("%s{\"threads\": %d, \"deterministic_ms\": %.3f, \"deterministic_speedup\": %.3f, "
+                   "\"mismatches\": %d, \"default_ms\": %.3f, \"default_speedup\": %.3f}",
+                   threads > 1 ? ", " : "", threads, det, serial_det / det,
+                   mismatches, fast, serial_fast / fast);
+        } else {
+            printf("%-8d %-14.1f %-10.2f %-11d %-14.1f %-10.2f\n", threads, det, serial_det / det,
+                   mismatches, fast, serial_fast / fast);
+        }
+        
+        if (threads < max_threads && threads * 2 > max_threads) {
+            threads = max_threads / 2;  // always finish with max_threads
+        }
+    }
+    
+    if (options->json) {
+        printf("]");
+    }
+    ai_set_threads(search_ctx, options->threads);
+}
+
+// Rounds over the suite for each cell counting path
+#define COUNTING_ROUNDS 100000
+#define COUNTING_CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define COUNTING_WIDE 4  // positions side by side in the large array
+
+// Keeps the timed loops from being optimized away
+static volatile long counting_sink;
+
+static double counting_ns(const char (*cells)[COUNTING_CELLS], int size, int count, bool *same) {
+    const char (*reference)[COUNTING_CELLS] = cells;
+    long checksum = 0;
+    double start = now_ms();
+    
+    for (int round = 0; round < COUNTING_ROUNDS; round++) {
+        for (int i = 0; i < count; i++) {
+            CellCounts counts;
+            cells_count(cells[i], size, &counts);
+            checksum += counts.pieces[0] + counts.pieces[1] + counts.pieces[2] + counts.pieces[3];
+        }
+    }
+    double ms = now_ms() - start;
+    
+    // Compare with the scalar path on every array
+    CellsBackend backend = cells_backend();
+    for (int i = 0; i < count; i++) {
+        CellCounts counts, expected;
+        cells_count(reference[i], size, &counts);
+        cells_set_backend(CELLS_SCALAR);
+        cells_count(reference[i], size, &expected);
+        cells_set_backend(backend);
+        if (memcmp(&counts, &expected, sizeof(CellCounts)) != 0) *same = false;
+    }
+    
+    counting_sink = checksum;
+    return ms * 1e6 / ((double)COUNTING_ROUNDS * count);
+}
+
+// Time of cells_count with every path the CPU supports, on the 8x8 cell
+// arrays of the suite and on arrays of COUNTING_WIDE positions (boards
+// without bitboards), next to the bitboard popcount used on 8x8 boards
+static void bench_counting(Board *board, const BenchOptions *options) {
+    static char cells[MAX_SUITE][COUNTING_CELLS];
+    static char wide[MAX_SUITE / COUNTING_WIDE + 1][COUNTING_CELLS * COUNTING_WIDE];
+    uint32_t white[MAX_SUITE], black[MAX_SUITE];
+    int wide_count = (suite_size + COUNTING_WIDE - 1) / COUNTING_WIDE;
+    
+    memset(wide, '.', sizeof(wide));
+    for (int i = 0; i < suite_size; i++) {
+        fen_parse(board, suite[i].fen);
+        memcpy(cells[i], board->cells, COUNTING_CELLS);
+        memcpy(wide[i / COUNTING_WIDE] + (i % COUNTING_WIDE) * COUNTING_CELLS, board->cells, COUNTING_CELLS);
+        white[i] = board->white_pieces;
+        black[i] = board->black_pieces;
+    }
+    
+    if (options->json) {
+        printf(",\n  \"counting\": [");
+    } else {
+        printf("\nCell counting, ns per array, %d rounds\n", COUNTING_ROUNDS);
+        printf("%-10s %-12s %-12s %s\n", "path", "64 cells", "256 cells", "same");
+    }
+    
+    CellsBackend selected = cells_backend();
+    bool first = true;
+    for (int b = 0; b < CELLS_BACKENDS; b++) {
+        if (!cells_set_backend((CellsBackend)b)) continue;
+        
+        bool same = true;
+        double small = counting_ns(cells, COUNTING_CELLS, suite_size, &same);
+        double large = counting_ns((const char (*)[COUNTING_CELLS])wide, COUNTING_CELLS * COUNTING_WIDE, wide_count, &same);
+        const char *name = cells_backend_name((CellsBackend)b);
+        
+        if (options->json) {
+            printf("%s{\"path\": \"%s\", \"ns_64\": %.2f, \"ns_256\": %.2f, \"same\": %s, \"selected\": %s}",
+                   first ? "" : ", ", name, small, large, same ? "true" : "false", b == (int)selected ? "true" : "false");
+        } else {
+            printf("%-10s %-12.2f %-12.2f %s%s\n", name, small, large, same ? "yes" : "NO",
+                   b == (int)selected ? "  (selected)" : "");
+        }
+        first = false;
+    }
+    cells_set_backend(selected);
+    
+    // 8x8 boards count with popcount on the bitboards instead
+    volatile uint32_t *white_pieces = white;
+    volatile uint32_t *black_pieces = black;
+    long checksum = 0;
+    double start = now_ms();
+    for (int round = 0; round < COUNTING_ROUNDS; round++) {
+        for (int i = 0; i < suite_size; i++) {
+            checksum += bitboard_popcount(white_pieces[i]) + bitboard_popcount(black_pieces[i]);
+        }
+    }
+    double bitboard = (now_ms() - start) * 1e6 / ((double)COUNTING_ROUNDS * suite_size);
+    counting_sink = checksum;
+    
+    if (options->json) {
+        printf(", {\"path\": \"bitboard\", \"ns_64\": %.2f}]", bitboard);
+    } else {
+        printf("%-10s %-12.2f %-12s %s\n", "bitboard", bitboard, "-", "-");
+    }
+}
+
+static int switch_index(const char *name) {
+    for (int i = 0; i < SWITCH_COUNT; i++) {
+        if (strcmp(switches[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --suite FILE     position suite (default %s)\n"
+            "  --eval FILE      evaluation tables (default: built-in, see %s)\n"
+            "  --depth N        fixed search depth (default 8)\n"
+            "  --time MS        timed search budget per position, 0 to skip (default 500)\n"
+            "  --tt MB          transposition table size, 0 disables it (default 64)\n"
+            "  --threads N      search threads (default 1)\n"
+            "  --ordering       compare move ordering off/on\n"
+            "  --pvs            compare principal variation search off/on\n"
+            "  --aspiration     compare aspiration windows off/on\n"
+            "  --lmr            compare late move reductions off/on\n"
+            "  --futility       compare futility pruning off/on\n"
+            "  --scaling [N]    thread scaling up to N threads (default: all cores)\n"
+            "  --counting       compare the cell counting paths (scalar, SSE2, AVX2)\n"
+            "  --json           machine-readable output\n",
+            program, DEFAULT_SUITE, BOARD_EVAL_FILE);
+}
+
+static bool parse_options(int argc, char *argv[], BenchOptions *options) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (strcmp(arg, "--suite") == 0 && has_value) {
+            options->suite_file = argv[++i];
+        } else if (strcmp(arg, "--eval") == 0 && has_value) {
+            options->eval_file = argv[++i];
+        } else if (strcmp(arg, "--depth") == 0 && has_value) {
+            options->depth = atoi(argv[++i]);
+        } else if (strcmp(arg, "--time") == 0 && has_value) {
+            options->time_ms = atoi(argv[++i]);
+        } else if (strcmp(arg, "--tt") == 0 && has_value) {
+            options->tt_size_mb = atoi(argv[++i]);
+        } else if (strcmp(arg, "--threads") == 0 && has_value) {
+            options->threads = atoi(argv[++i]);
+        } else if (strncmp(arg, "--", 2) == 0 && switch_index(arg + 2) >= 0) {
+            options->compare[switch_index(arg + 2)] = true;
+        } else if (strcmp(arg, "--scaling") == 0) {
+            if (has_value && argv[i + 1][0] != '-') {
+                options->scaling_threads = atoi(argv[++i]);
+            } else {
+                options->scaling_threads = cores > 0 ? (int)cores : 1;
+            }
+        } else if (strcmp(arg, "--counting") == 0) {
+            options->counting = true;
+        } else if (strcmp(arg, "--json") == 0) {
+            options->json = true;
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    
+    if (options->depth < 1 || options->depth > 128) {
+        fprintf(stderr, "Depth must be between 1 and 128\n");
+        return false;
+    }
+    if (options->threads < 1) options->threads = 1;
+    if (options->threads > AI_MAX_THREADS) options->threads = AI_MAX_THREADS;
+    if (options->scaling_threads > AI_MAX_THREADS) options->scaling_threads = AI_MAX_THREADS;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions options = {DEFAULT_SUITE, NULL, 8, 500, 64, 1, 0, false, {false}, false};
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+    if (options.eval_file && !board_eval_load(options.eval_file)) {
+        fprintf(stderr, "Cannot load evaluation tables %s\n", options.eval_file);
+        return 1;
+    }
+    
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    if (!board) {
+        fprintf(stderr, "Failed to create board!\n");
+        return 1;
+    }
+    if (!load_suite(options.suite_file, board)) {
+        board_free(board);
+        return 1;
+    }
+    
+    search_ctx = ai_context_create();
+    if (!search_ctx) {
+        fprintf(stderr, "Failed to create the search context!\n");
+        board_free(board);
+        return 1;
+    }
+    TranspositionTable *tt = options.tt_size_mb > 0 ? tt_create(options.tt_size_mb) : NULL;
+    ai_set_transposition_table(search_ctx, tt);
+    ai_set_threads(search_ctx, options.threads);
+    
+    if (options.json) {
+        printf("{\n  \"suite\": \"%s\", \"depth\": %d, \"time_ms\": %d, \"tt_mb\": %d, \"threads\": %d,\n",
+               options.suite_file, options.depth, options.time_ms, options.tt_size_mb, options.threads);
+    }
+    
+    bench_suite(board, &options, tt);
+    for (int i = 0; i < SWITCH_COUNT; i++) {
+        if (options.compare[i]) {
+            bench_switch(board, &options, tt, &switches[i]);
+        }
+    }
+    if (options.scaling_threads > 0) {
+        bench_threads(board, &options, tt);
+    }
+    if (options.counting) {
+        bench_counting(board, &options);
+    }
+    
+    if (options.json) {
+        printf("\n}\n");
+    }
+    
+    board_free(board);
+    ai_context_free(search_ctx);
+    tt_free(tt);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "bitboard.h"
+#include <string.h>
+
+void bitboard_sync(Board *board) {
+    board->white_pieces = 0;
+    board->black_pieces = 0;
+    board->kings = 0;
+    board->hash = board->white_to_move ? 0 : board_zobrist_black_to_move;
+    memset(board->eval, 0, sizeof(board->eval));
+
+    for (int square = 0; square < BB_SQUARES; square++) {
+        Coordinate coord = bitboard_coordinate(square);
+        char piece = board_get(board, coord.row, coord.col);
+        uint32_t bit = 1u << square;
+
+        if (piece == 'b' || piece == 'B') board->white_pieces |= bit;
+        if (piece == 'c' || piece == 'C') board->black_pieces |= bit;
+        if (piece == 'B' || piece == 'C') board->kings |= bit;
+        board->hash ^= board_zobrist_key(square, piece);
+        for (int term = 0; term < BOARD_EVAL_TERMS; term++) {
+            board->eval[term] += board_eval_tables[term][square][board_piece_kind(piece)];
+        }
+    }
+}
+
+// Pieces of the side to move allowed to travel in the given direction.
+// White men move up (towards row 0), black men move down, kings both ways.
+static inline uint32_t pieces_for_direction(const Board *board, int direction) {
+    uint32_t own = board->white_to_move ? board->white_pieces : board->black_pieces;
+    bool up = (direction == BB_UP_LEFT || direction == BB_UP_RIGHT);
+
+    if (up == board->white_to_move) {
+        return own;
+    }
+    return own & board->kings;
+}
+
+// Pieces that can jump in `direction`: the neighbour is an opponent piece
+// and the square behind it is empty.
+static inline uint32_t jumpers_in_direction(const Board *board, int direction, uint32_t empty, uint32_t opponent) {
+    int back = BB_DIRECTIONS - 1 - direction;
+    uint32_t victims = opponent & bitboard_step(empty, back);
+    return pieces_for_direction(board, direction) & bitboard_step(victims, back);
+}
+
+static inline uint32_t movers_in_direction(const Board *board, int direction, uint32_t empty) {
+    int back = BB_DIRECTIONS - 1 - direction;
+    return pieces_for_direction(board, direction) & bitboard_step(empty, back);
+}
+
+uint32_t bitboard_jumpers(const Board *board) {
+    uint32_t empty = ~(board->white_pieces | board->black_pieces);
+    uint32_t opponent = board->white_to_move ? board->black_pieces : board->white_pieces;
+    uint32_t jumpers = 0;
+
+    for (int d = 0; d < BB_DIRECTIONS; d++) {
+        jumpers |= jumpers_in_direction(board, d, empty, opponent);
+    }
+    return jumpers;
+}
+
+uint32_t bitboard_movers(const Board *board) {
+    uint32_t empty = ~(board->white_pieces | board->black_pieces);
+    uint32_t movers = 0;
+
+    for (int d = 0; d < BB_DIRECTIONS; d++) {
+        movers |= movers_in_direction(board, d, empty);
+    }
+    return movers;
+}
+
+// Continue the capture chain in `chain` from `square`. Jumped pieces stay
+// on the board until the move is over, so they block landings and cannot be
+// jumped twice. Every maximal chain is added to moves; a man that reaches
+// the promotion row ends its move there.
+static void add_jump_chains(const Board *board, Move *chain, int square, bool king,
+                            uint32_t empty, uint32_t opponent, MoveList *moves) {
+    uint32_t bit = 1u << square;
+    uint32_t promotion_row = board->white_to_move ? BB_TOP_ROW : BB_BOTTOM_ROW;
+    bool extended = false;
+    
+    if (chain->jumps == 0 || king || !(bit & promotion_row)) {
+        for (int d = 0; d < BB_DIRECTIONS && chain->jumps < MAX_JUMPS; d++) {
+            bool up = (d == BB_UP_LEFT || d == BB_UP_RIGHT);
+            if (!king && up != board->white_to_move) continue;
+            
+            uint32_t victim = bitboard_step(bit, d) & opponent & ~chain->captured;
+            uint32_t landing = bitboard_step(victim, d) & empty;
+            if (!landing) continue;
+            
+            int target = bitboard_lowest(landing);
+            Coordinate to = bitboard_coordinate(target);
+            Move next = *chain;
+            next.to = to;
+            next.path[next.jumps++] = (uint8_t)(to.row * BITBOARD_WIDTH + to.col);
+            next.captured |= victim;
+            
+            add_jump_chains(board, &next, target, king, empty, opponent, moves);
+            extended = true;
+        }
+    }
+    
+    if (!extended && chain->jumps > 0 && moves->count < MAX_MOVES) {
+        moves->moves[moves->count++] = *chain;
+    }
+}
+
+void bitboard_generate_moves(const Board *board, uint32_t from, bool forced, MoveList *moves) {
+    moves->count = 0;
+
+    uint32_t empty = ~(board->white_pieces | board->black_pieces);
+    uint32_t opponent = board->white_to_move ? board->black_pieces : board->white_pieces;
+    uint32_t steps[BB_DIRECTIONS];
+    uint32_t any_jump = 0;
+    uint32_t any_step = 0;
+
+    for (int d = 0; d < BB_DIRECTIONS; d++) {
+        steps[d] = movers_in_direction(board, d, empty) & from;
+        any_jump |= jumpers_in_direction(board, d, empty, opponent) & from;
+        any_step |= steps[d];
+    }
+
+    // Capture chains first, in square order (same order as the cell scan)
+    for (uint32_t pieces = any_jump; pieces; pieces &= pieces - 1) {
+        int square = bitboard_lowest(pieces);
+        uint32_t bit = 1u << square;
+        Move chain = {bitboard_coordinate(square), bitboard_coordinate(square), true, 0, {0}, 0};
+
+        // The moving piece's own square is free to land on again
+        add_jump_chains(board, &chain, square, (board->kings & bit) != 0, empty | bit, opponent, moves);
+    }
+
+    if (forced && moves->count > 0) {
+        return;
+    }
+
+    for (uint32_t pieces = any_step; pieces; pieces &= pieces - 1) {
+        int square = bitboard_lowest(pieces);
+        uint32_t bit = 1u << square;
+
+        for (int d = 0; d < BB_DIRECTIONS; d++) {
+            if (steps[d] & bit) {
+                Move move = {bitboard_coordinate(square), bitboard_coordinate(bitboard_lowest(bitboard_step(bit, d))), false, 0, {0}, 0};
+                moves->moves[moves->count++] = move;
+            }
+        }
+    }
+}
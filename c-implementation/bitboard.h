@@ -0,0 +1,94 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "board.h"
+#include <stdint.h>
+
+// 32-square bitboard layout for the standard 8x8 board.
+// Only dark squares ((row + col) odd) can hold pieces, they are numbered
+// row by row: square = row * 4 + col / 2, so bit 0 is (0,1) and bit 31 is (7,6).
+#define BB_SQUARES 32
+
+#define BB_EVEN_ROWS  0x0F0F0F0Fu  // rows 0, 2, 4, 6 (pieces on odd columns)
+#define BB_ODD_ROWS   0xF0F0F0F0u  // rows 1, 3, 5, 7 (pieces on even columns)
+#define BB_LEFT_EDGE  0x10101010u  // column 0
+#define BB_RIGHT_EDGE 0x08080808u  // column 7
+#define BB_TOP_ROW    0x0000000Fu  // row 0, white promotes here
+#define BB_BOTTOM_ROW 0xF0000000u  // row 7, black promotes here
+
+// Diagonal directions, listed in the order moves are generated.
+// The opposite of direction d is (BB_DIRECTIONS - 1 - d).
+typedef enum BitboardDirection {
+    BB_DOWN_LEFT,
+    BB_DOWN_RIGHT,
+    BB_UP_LEFT,
+    BB_UP_RIGHT,
+    BB_DIRECTIONS
+} BitboardDirection;
+
+// Shift every square in the set one step in the given direction.
+// Squares that would leave the board are dropped.
+static inline uint32_t bitboard_step(uint32_t squares, int direction) {
+    switch (direction) {
+        case BB_DOWN_LEFT:
+            return ((squares & BB_EVEN_ROWS) << 4) | ((squares & BB_ODD_ROWS & ~BB_LEFT_EDGE) << 3);
+        case BB_DOWN_RIGHT:
+            return ((squares & BB_EVEN_ROWS & ~BB_RIGHT_EDGE) << 5) | ((squares & BB_ODD_ROWS) << 4);
+        case BB_UP_LEFT:
+            return ((squares & BB_EVEN_ROWS) >> 4) | ((squares & BB_ODD_ROWS & ~BB_LEFT_EDGE) >> 5);
+        default:
+            return ((squares & BB_EVEN_ROWS & ~BB_RIGHT_EDGE) >> 3) | ((squares & BB_ODD_ROWS) >> 4);
+    }
+}
+
+static inline int bitboard_popcount(uint32_t squares) {
+#if defined(__GNUC__)
+    return __builtin_popcount(squares);
+#else
+    int count = 0;
+    while (squares) {
+        squares &= squares - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set square, squares must not be empty
+static inline int bitboard_lowest(uint32_t squares) {
+#if defined(__GNUC__)
+    return __builtin_ctz(squares);
+#else
+    int square = 0;
+    while (!(squares & 1u)) {
+        squares >>= 1;
+        square++;
+    }
+    return square;
+#endif
+}
+
+static inline Coordinate bitboard_coordinate(int square) {
+    int row = square / 4;
+    Coordinate coord = {row, 2 * (square % 4) + !(row & 1)};
+    return coord;
+}
+
+// Returns -1 for light squares, which are never on the bitboard
+static inline int bitboard_square(int row, int col) {
+    return ((row + col) & 1) ? row * 4 + col / 2 : -1;
+}
+
+// Rebuild the masks and the Zobrist key from board->cells
+void bitboard_sync(Board *board);
+
+// Pieces of the side to move that can capture / make a quiet move
+uint32_t bitboard_jumpers(const Board *board);
+uint32_t bitboard_movers(const Board *board);
+
+// Generate moves for the pieces of the side to move contained in `from`.
+// Captures are complete jump chains and come first; with `forced` set only
+// captures are returned if any exist.
+void bitboard_generate_moves(const Board *board, uint32_t from, bool forced, MoveList *moves);
+
+#endif
@@ -1,9 +1,134 @@
 #include "board.h"
+#include "bitboard.h"
+#include "cells.h"
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+uint64_t board_zobrist_pieces[32][4];
+uint64_t board_zobrist_black_to_move;
+int board_eval_tables[BOARD_EVAL_TERMS][32][BOARD_PIECE_KINDS];
+
+// splitmix64, fixed seed so hashes are identical between runs
+static uint64_t zobrist_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void board_zobrist_init(void) {
+    static bool initialized = false;
+    if (initialized) return;
+    
+    uint64_t state = 0x636865636B657273ull;
+    for (int square = 0; square < 32; square++) {
+        for (int piece = 0; piece < 4; piece++) {
+            board_zobrist_pieces[square][piece] = zobrist_next(&state);
+        }
+    }
+    board_zobrist_black_to_move = zobrist_next(&state);
+    initialized = true;
+}
+
+// Same values as the full scans of evaluate_standard and evaluate_ending
+static void board_eval_init(void) {
+    static bool initialized = false;
+    if (initialized) return;
+    
+    for (int square = 0; square < 32; square++) {
+        int row = square / 4;
+        int col = 2 * (square % 4) + !(row & 1);
+        bool center = 2 < row && row < 5 && 1 < col && col < 6;
+        int (*standard)[BOARD_PIECE_KINDS] = &board_eval_tables[BOARD_EVAL_STANDARD][square];
+        int (*ending)[BOARD_PIECE_KINDS] = &board_eval_tables[BOARD_EVAL_ENDING][square];
+        
+        (*standard)[0] = -(center ? 50 : (row < 4 ? 45 : 40));
+        (*standard)[1] = -60;
+        (*standard)[2] = center ? 50 : (row > 3 ? 45 : 40);
+        (*standard)[3] = 60;
+        
+        (*ending)[0] = -2;
+        (*ending)[1] = -3;
+        (*ending)[2] = 2;
+        (*ending)[3] = 3;
+    }
+    initialized = true;
+}
+
+static const char *const board_eval_term_names[BOARD_EVAL_TERMS] = {"standard", "ending"};
+
+// A table is a "<term> <piece>" line followed by 8 rows of 4 values, one per
+// dark square; values are the piece's worth to its owner
+bool board_eval_load(const char *path) {
+    board_eval_init();
+    
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    
+    int tables[BOARD_EVAL_TERMS][32][BOARD_PIECE_KINDS];
+    memcpy(tables, board_eval_tables, sizeof(tables));
+    
+    char line[256];
+    int line_number = 0;
+    int term = -1;
+    int kind = -1;
+    int sign = 1;
+    int row = 8;  // rows still missing from the current table: none
+    bool ok = true;
+    
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        
+        char *text = line;
+        while (isspace((unsigned char)*text)) text++;
+        if (*text == '\0') continue;
+        
+        if (isalpha((unsigned char)*text)) {
+            char name[16];
+            char piece;
+            char extra;
+            ok = row == 8 && sscanf(text, "%15s %c %c", name, &piece, &extra) == 2;
+            term = -1;
+            for (int t = 0; ok && t < BOARD_EVAL_TERMS; t++) {
+                if (strcmp(name, board_eval_term_names[t]) == 0) term = t;
+            }
+            kind = ok ? board_piece_kind(piece) : BOARD_PIECE_KINDS - 1;
+            ok = ok && term >= 0 && kind < BOARD_PIECE_KINDS - 1;
+            sign = (piece == 'b' || piece == 'B') ? -1 : 1;
+            row = 0;
+        } else {
+            int values[4];
+            char extra;
+            ok = row < 8 && sscanf(text, "%d %d %d %d %c", &values[0], &values[1], &values[2], &values[3], &extra) == 4;
+            for (int i = 0; ok && i < 4; i++) {
+                tables[term][row * 4 + i][kind] = sign * values[i];
+            }
+            row++;
+        }
+    }
+    fclose(file);
+    
+    if (ok && row != 8) {
+        line_number++;
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "%s:%d: invalid evaluation table\n", path, line_number);
+        return false;
+    }
+    
+    memcpy(board_eval_tables, tables, sizeof(tables));
+    return true;
+}
+
 Board* board_create(int width, int height) {
+    board_zobrist_init();
+    board_eval_init();
+    
     Board *board = (Board*)malloc(sizeof(Board));
     if (!board) return NULL;
     
@@ -17,6 +142,12 @@ Board* board_create(int width, int height) {
     board->height = height;
     board->white_to_move = true;
     board->game_end = false;
+    board->use_bitboards = (width == BITBOARD_WIDTH && height == BITBOARD_HEIGHT);
+    board->white_pieces = 0;
+    board->black_pieces = 0;
+    board->kings = 0;
+    board->hash = 0;
+    memset(board->eval, 0, sizeof(board->eval));
     
     return board;
 }
@@ -26,6 +157,10 @@ void board_init(Board *board, const char *cells, bool white_to_move) {
     memcpy(board->cells, cells, size);
     board->white_to_move = white_to_move;
     board->game_end = false;
+    
+    if (board->use_bitboards) {
+        bitboard_sync(board);
+    }
 }
 
 void board_free(Board *board) {
@@ -42,29 +177,123 @@ void board_copy(Board *dest, const Board *src) {
     dest->height = src->height;
     dest->white_to_move = src->white_to_move;
     dest->game_end = src->game_end;
+    dest->use_bitboards = src->use_bitboards;
+    dest->white_pieces = src->white_pieces;
+    dest->black_pieces = src->black_pieces;
+    dest->kings = src->kings;
+    dest->hash = src->hash;
+    memcpy(dest->eval, src->eval, sizeof(dest->eval));
 }
 
 void board_count_pieces(const Board *board, int *num_white, int *num_black) {
-    *num_white = 0;
-    *num_black = 0;
+    if (board->use_bitboards) {
+        *num_white = bitboard_popcount(board->white_pieces);
+        *num_black = bitboard_popcount(board->black_pieces);
+        return;
+    }
     
-    for (int i = 0; i < board->height; i++) {
-        for (int j = 0; j < board->width; j++) {
-            char piece = board_get(board, i, j);
-            if (piece == 'b' || piece == 'B') {
-                (*num_white)++;
-            }
-            if (piece == 'c' || piece == 'C') {
-                (*num_black)++;
+    CellCounts counts;
+    cells_count(board->cells, board->width * board->height, &counts);
+    *num_white = counts.pieces[0] + counts.pieces[1];
+    *num_black = counts.pieces[2] + counts.pieces[3];
+}
+
+static bool jumped_over(const Board *board, const Move *move, int row, int col) {
+    Coordinate at = move->from;
+    for (int k = 0; k < move->jumps; k++) {
+        Coordinate next = board_jump_landing(board, move, k);
+        if ((at.row + next.row) / 2 == row && (at.col + next.col) / 2 == col) {
+            return true;
+        }
+        at = next;
+    }
+    return false;
+}
+
+// Append the jump to move->to to the chain and keep jumping from there.
+// Every maximal chain is added to captures; a man that reaches the
+// promotion row ends its move there.
+static void extend_jump(const Board *board, char figure, Coordinate origin, Move *move, MoveList *captures) {
+    Move chain = *move;
+    chain.path[chain.jumps++] = (uint8_t)board_index(board, chain.to.row, chain.to.col);
+    
+    Coordinate at = chain.to;
+    bool white = (figure == 'b' || figure == 'B');
+    bool promoted = (figure == 'b' && at.row == 0) || (figure == 'c' && at.row == board->height - 1);
+    bool extended = false;
+    
+    for (int d = 0; d < 4 && !promoted && chain.jumps < MAX_JUMPS; d++) {
+        int dr = d < 2 ? 1 : -1;
+        int dc = (d % 2 == 0) ? -1 : 1;
+        
+        // Men only jump forward: white up, black down
+        if ((figure == 'b' && dr > 0) || (figure == 'c' && dr < 0)) continue;
+        
+        int mid_row = at.row + dr, mid_col = at.col + dc;
+        int land_row = at.row + 2 * dr, land_col = at.col + 2 * dc;
+        if (land_row < 0 || land_row >= board->height || land_col < 0 || land_col >= board->width) continue;
+        
+        char victim = board_get(board, mid_row, mid_col);
+        bool victim_white = (victim == 'b' || victim == 'B');
+        if (victim == '.' || victim_white == white || jumped_over(board, &chain, mid_row, mid_col)) continue;
+        
+        // The square the piece started from is empty while it jumps
+        bool back_to_origin = (land_row == origin.row && land_col == origin.col);
+        if (board_get(board, land_row, land_col) != '.' && !back_to_origin) continue;
+        
+        Move next = chain;
+        next.to.row = land_row;
+        next.to.col = land_col;
+        extend_jump(board, figure, origin, &next, captures);
+        extended = true;
+    }
+    
+    if (!extended && captures->count < MAX_MOVES) {
+        captures->moves[captures->count++] = chain;
+    }
+}
+
+// Append the moves of the piece `figure` on `coord` to `moves`: its capture
+// chains if `captures` is set, its quiet steps otherwise. Generating both
+// kinds straight into the caller's list keeps captures first without any
+// temporary lists.
+static void add_piece_moves(const Board *board, Coordinate coord, char figure, bool captures, MoveList *moves) {
+    bool white = (figure == 'b' || figure == 'B');
+    
+    // Down-left, down-right, up-left, up-right
+    for (int d = 0; d < 4; d++) {
+        int dr = d < 2 ? 1 : -1;
+        int dc = (d % 2 == 0) ? -1 : 1;
+        
+        // Men only move forward: white up, black down
+        if ((figure == 'b' && dr > 0) || (figure == 'c' && dr < 0)) continue;
+        
+        int row = coord.row + dr, col = coord.col + dc;
+        if (row < 0 || row >= board->height || col < 0 || col >= board->width) continue;
+        
+        char target = board_get(board, row, col);
+        if (target == '.') {
+            if (!captures && moves->count < MAX_MOVES) {
+                Move move = {{coord.row, coord.col}, {row, col}, false, 0, {0}, 0};
+                moves->moves[moves->count++] = move;
             }
+            continue;
+        }
+        
+        int land_row = row + dr, land_col = col + dc;
+        bool target_white = (target == 'b' || target == 'B');
+        if (!captures || target_white == white ||
+            land_row < 0 || land_row >= board->height || land_col < 0 || land_col >= board->width ||
+            board_get(board, land_row, land_col) != '.') {
+            continue;
         }
+        Move move = {{coord.row, coord.col}, {land_row, land_col}, true, 0, {0}, 0};
+        extend_jump(board, figure, coord, &move, moves);
     }
 }
 
 void board_find_valid_moves_for_piece(const Board *board, Coordinate coord, bool forced, MoveList *moves) {
     moves->count = 0;
-    MoveList captures = {0};
-    MoveList regular = {0};
     
     char figure = board_get(board, coord.row, coord.col);
     if (figure == '.') return;
@@ -73,103 +302,34 @@ void board_find_valid_moves_for_piece(const Board *board, Coordinate coord, bool
     bool is_white = (figure == 'b' || figure == 'B');
     if (is_white != board->white_to_move) return;
     
-    // Kings and black pieces (b/B) can move down (increasing row)
-    if (figure != 'c') {
-        if (coord.row < board->height - 1) {
-            // Down-left
-            if (coord.col - 1 >= 0) {
-                char target = board_get(board, coord.row + 1, coord.col - 1);
-                if (target == '.') {
-                    Move move = {{coord.row, coord.col}, {coord.row + 1, coord.col - 1}, false};
-                    regular.moves[regular.count++] = move;
-                } else if (coord.row + 2 < board->height && coord.col - 2 >= 0) {
-                    char jump_target = board_get(board, coord.row + 2, coord.col - 2);
-                    if (jump_target == '.') {
-                        bool target_is_white = (target == 'b' || target == 'B');
-                        if (is_white != target_is_white && target != '.') {
-                            Move move = {{coord.row, coord.col}, {coord.row + 2, coord.col - 2}, true};
-                            captures.moves[captures.count++] = move;
-                        }
-                    }
-                }
-            }
-            // Down-right
-            if (coord.col + 1 < board->width) {
-                char target = board_get(board, coord.row + 1, coord.col + 1);
-                if (target == '.') {
-                    Move move = {{coord.row, coord.col}, {coord.row + 1, coord.col + 1}, false};
-                    regular.moves[regular.count++] = move;
-                } else if (coord.row + 2 < board->height && coord.col + 2 < board->width) {
-                    char jump_target = board_get(board, coord.row + 2, coord.col + 2);
-                    if (jump_target == '.') {
-                        bool target_is_white = (target == 'b' || target == 'B');
-                        if (is_white != target_is_white && target != '.') {
-                            Move move = {{coord.row, coord.col}, {coord.row + 2, coord.col + 2}, true};
-                            captures.moves[captures.count++] = move;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    // Kings and black pieces (c/C) can move up (decreasing row)
-    if (figure != 'b') {
-        if (coord.row > 0) {
-            // Up-left
-            if (coord.col - 1 >= 0) {
-                char target = board_get(board, coord.row - 1, coord.col - 1);
-                if (target == '.') {
-                    Move move = {{coord.row, coord.col}, {coord.row - 1, coord.col - 1}, false};
-                    regular.moves[regular.count++] = move;
-                } else if (coord.row - 2 >= 0 && coord.col - 2 >= 0) {
-                    char jump_target = board_get(board, coord.row - 2, coord.col - 2);
-                    if (jump_target == '.') {
-                        bool target_is_white = (target == 'b' || target == 'B');
-                        if (is_white != target_is_white && target != '.') {
-                            Move move = {{coord.row, coord.col}, {coord.row - 2, coord.col - 2}, true};
-                            captures.moves[captures.count++] = move;
-                        }
-                    }
-                }
-            }
-            // Up-right
-            if (coord.col + 1 < board->width) {
-                char target = board_get(board, coord.row - 1, coord.col + 1);
-                if (target == '.') {
-                    Move move = {{coord.row, coord.col}, {coord.row - 1, coord.col + 1}, false};
-                    regular.moves[regular.count++] = move;
-                } else if (coord.row - 2 >= 0 && coord.col + 2 < board->width) {
-                    char jump_target = board_get(board, coord.row - 2, coord.col + 2);
-                    if (jump_target == '.') {
-                        bool target_is_white = (target == 'b' || target == 'B');
-                        if (is_white != target_is_white && target != '.') {
-                            Move move = {{coord.row, coord.col}, {coord.row - 2, coord.col + 2}, true};
-                            captures.moves[captures.count++] = move;
-                        }
-                    }
-                }
-            }
+    if (board->use_bitboards) {
+        int square = bitboard_square(coord.row, coord.col);
+        if (square >= 0) {
+            bitboard_generate_moves(board, 1u << square, forced, moves);
         }
+        return;
     }
     
-    // If forced and captures exist, only return captures
-    if (forced && captures.count > 0) {
-        memcpy(moves, &captures, sizeof(MoveList));
-    } else {
-        // Return captures first, then regular moves
-        for (int i = 0; i < captures.count; i++) {
-            moves->moves[moves->count++] = captures.moves[i];
-        }
-        for (int i = 0; i < regular.count; i++) {
-            moves->moves[moves->count++] = regular.moves[i];
-        }
+    // Captures first; if forced and captures exist, only captures
+    add_piece_moves(board, coord, figure, true, moves);
+    if (!forced || moves->count == 0) {
+        add_piece_moves(board, coord, figure, false, moves);
     }
 }
 
 void board_find_capturing_moves(const Board *board, MoveList *pieces) {
     pieces->count = 0;
     
+    if (board->use_bitboards) {
+        for (uint32_t jumpers = bitboard_jumpers(board); jumpers; jumpers &= jumpers - 1) {
+            Coordinate coord = bitboard_coordinate(bitboard_lowest(jumpers));
+            pieces->moves[pieces->count].from = coord;
+            pieces->moves[pieces->count].to = coord;
+            pieces->count++;
+        }
+        return;
+    }
+    
     for (int i = 0; i < board->height; i++) {
         for (int j = 0; j < board->width; j++) {
             char piece = board_get(board, i, j);
@@ -208,54 +368,56 @@ void board_find_capturing_moves(const Board *board, MoveList *pieces) {
 }
 
 void board_generate_all_moves(const Board *board, bool forced_capture, MoveList *moves) {
-    moves->count = 0;
-    MoveList captures = {0};
-    MoveList all = {0};
+    if (board->use_bitboards) {
+        bitboard_generate_moves(board, 0xFFFFFFFFu, forced_capture, moves);
+        return;
+    }
     
-    for (int i = 0; i < board->height; i++) {
-        for (int j = 0; j < board->width; j++) {
-            char piece = board_get(board, i, j);
-            bool is_white = (piece == 'b' || piece == 'B');
-            
-            if ((board->white_to_move && is_white) || (!board->white_to_move && !is_white && piece != '.')) {
-                Coordinate coord = {i, j};
-                MoveList piece_moves;
-                board_find_valid_moves_for_piece(board, coord, false, &piece_moves);
+    // Captures of every piece first, then the regular moves, each in cell order.
+    // If forced capture and captures exist, only captures are returned.
+    moves->count = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        bool captures = pass == 0;
+        if (!captures && forced_capture && moves->count > 0) break;
+        
+        for (int i = 0; i < board->height; i++) {
+            for (int j = 0; j < board->width; j++) {
+                char piece = board_get(board, i, j);
+                bool is_white = (piece == 'b' || piece == 'B');
                 
-                for (int k = 0; k < piece_moves.count; k++) {
-                    if (piece_moves.moves[k].is_capture) {
-                        captures.moves[captures.count++] = piece_moves.moves[k];
-                    } else {
-                        all.moves[all.count++] = piece_moves.moves[k];
-                    }
+                if ((board->white_to_move && is_white) || (!board->white_to_move && !is_white && piece != '.')) {
+                    Coordinate coord = {i, j};
+                    add_piece_moves(board, coord, piece, captures, moves);
                 }
             }
         }
     }
-    
-    // If forced capture and captures exist, only return captures
-    if (forced_capture && captures.count > 0) {
-        memcpy(moves, &captures, sizeof(MoveList));
-    } else {
-        // Return all moves (captures + regular)
-        for (int i = 0; i < captures.count; i++) {
-            moves->moves[moves->count++] = captures.moves[i];
-        }
-        for (int i = 0; i < all.count; i++) {
-            moves->moves[moves->count++] = all.moves[i];
-        }
-    }
 }
 
 bool board_apply_move(Board *board, const Move *move) {
+    MoveUndo undo;
+    return board_make_move(board, move, &undo);
+}
+
+// Apply a move in place, recording what board_unmake_move needs to revert it
+bool board_make_move(Board *board, const Move *move, MoveUndo *undo) {
     char piece = board_get(board, move->from.row, move->from.col);
     if (piece == '.') return false;
     
-    // Handle capture
+    undo->piece = piece;
+    
+    // Remove the jumped pieces, one per hop
     if (move->is_capture) {
-        int mid_row = (move->from.row + move->to.row) / 2;
-        int mid_col = (move->from.col + move->to.col) / 2;
-        board_set(board, mid_row, mid_col, '.');
+        int jumps = move->jumps > 0 ? move->jumps : 1;
+        Coordinate at = move->from;
+        for (int k = 0; k < jumps; k++) {
+            Coordinate next = board_jump_landing(board, move, k);
+            int mid_row = (at.row + next.row) / 2;
+            int mid_col = (at.col + next.col) / 2;
+            undo->captured[k] = board_get(board, mid_row, mid_col);
+            board_set(board, mid_row, mid_col, '.');
+            at = next;
+        }
     }
     
     // Handle promotion
@@ -266,16 +428,73 @@ bool board_apply_move(Board *board, const Move *move) {
         piece = 'C';
     }
     
-    // Move piece
-    board_set(board, move->to.row, move->to.col, piece);
+    // Move piece (a king's chain can end where it started)
     board_set(board, move->from.row, move->from.col, '.');
+    board_set(board, move->to.row, move->to.col, piece);
     
     // Switch player
     board->white_to_move = !board->white_to_move;
+    if (board->use_bitboards) {
+        board->hash ^= board_zobrist_black_to_move;
+    }
     
     return true;
 }
 
+// Take back a move made with board_make_move: restores the captured pieces
+// and reverts a promotion by putting back the original piece
+void board_unmake_move(Board *board, const Move *move, const MoveUndo *undo) {
+    board->white_to_move = !board->white_to_move;
+    if (board->use_bitboards) {
+        board->hash ^= board_zobrist_black_to_move;
+    }
+    
+    board_set(board, move->to.row, move->to.col, '.');
+    board_set(board, move->from.row, move->from.col, undo->piece);
+    
+    if (move->is_capture) {
+        int jumps = move->jumps > 0 ? move->jumps : 1;
+        Coordinate at = move->from;
+        for (int k = 0; k < jumps; k++) {
+            Coordinate next = board_jump_landing(board, move, k);
+            board_set(board, (at.row + next.row) / 2, (at.col + next.col) / 2, undo->captured[k]);
+            at = next;
+        }
+    }
+}
+
+bool board_moves_equal(const Move *a, const Move *b) {
+    return a->from.row == b->from.row && a->from.col == b->from.col &&
+           a->to.row == b->to.row && a->to.col == b->to.col &&
+           a->is_capture == b->is_capture && a->jumps == b->jumps &&
+           memcmp(a->path, b->path, a->jumps) == 0;
+}
+
+// A move exists if any piece can capture or step; on bitboards that is one
+// mask test, other boards stop scanning at the first piece that can move
+bool board_has_moves(const Board *board) {
+    if (board->use_bitboards) {
+        return (bitboard_movers(board) | bitboard_jumpers(board)) != 0;
+    }
+    
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            char piece = board_get(board, i, j);
+            bool is_white = (piece == 'b' || piece == 'B');
+            
+            if ((board->white_to_move && is_white) || (!board->white_to_move && !is_white && piece != '.')) {
+                Coordinate coord = {i, j};
+                MoveList piece_moves;
+                board_find_valid_moves_for_piece(board, coord, false, &piece_moves);
+                if (piece_moves.count > 0) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
 bool board_is_game_over(const Board *board) {
     if (board->game_end) return true;
     
@@ -287,10 +506,7 @@ bool board_is_game_over(const Board *board) {
     }
     
     // Check if current player has any moves
-    MoveList moves;
-    board_generate_all_moves(board, false, &moves);
-    
-    return moves.count == 0;
+    return !board_has_moves(board);
 }
 
 void board_find_differences(const Board *current, const Board *previous, MoveList *differences) {
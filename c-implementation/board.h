@@ -2,8 +2,21 @@
 #define BOARD_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #define MAX_MOVES 100
+#define MAX_JUMPS 12          // a chain can capture at most every opponent piece
+
+// Standard 8x8 boards are additionally kept as 32-square bitboards
+// (see bitboard.h); other sizes fall back to scanning the cell array.
+#define BITBOARD_WIDTH 8
+#define BITBOARD_HEIGHT 8
+
+// Incrementally evaluated terms, see board_eval_tables
+#define BOARD_EVAL_STANDARD 0
+#define BOARD_EVAL_ENDING 1
+#define BOARD_EVAL_TERMS 2
+#define BOARD_PIECE_KINDS 5   // b, B, c, C, empty
 
 typedef struct Board {
     char *cells;          // 1D array of cells
@@ -11,17 +24,32 @@ typedef struct Board {
     int height;
     bool white_to_move;
     bool game_end;
+    bool use_bitboards;   // true for 8x8 boards, masks below are kept in sync
+    uint32_t white_pieces; // b and B
+    uint32_t black_pieces; // c and C
+    uint32_t kings;        // B and C
+    uint64_t hash;         // Zobrist key of the bitboard position (0 for other sizes)
+    int eval[BOARD_EVAL_TERMS]; // piece-square sums, see board_eval_tables (0 for other sizes)
 } Board;
 
+// Bytes keep a Move at 24 bytes; cell indices in Move.path already limit
+// boards to 256 cells
 typedef struct Coordinate {
-    int row;
-    int col;
+    int8_t row;
+    int8_t col;
 } Coordinate;
 
+// A quiet move, or a complete capture chain played as one move.
+// path holds the landing square of every jump as a cell index (board_index),
+// path[jumps - 1] is `to`; the jumped pieces are the midpoints of each hop.
+// A capture with jumps == 0 is read as a single jump from `from` to `to`.
 typedef struct Move {
     Coordinate from;
     Coordinate to;
     bool is_capture;
+    uint8_t jumps;
+    uint8_t path[MAX_JUMPS];
+    uint32_t captured;    // bitboard squares of the jumped pieces (0 without bitboards)
 } Move;
 
 typedef struct MoveList {
@@ -29,12 +57,55 @@ typedef struct MoveList {
     int count;
 } MoveList;
 
+// State needed to take back a move made with board_make_move
+typedef struct MoveUndo {
+    char piece;                // moving piece before a possible promotion
+    char captured[MAX_JUMPS];  // jumped pieces in path order
+} MoveUndo;
+
 // Board initialization and cleanup
 Board* board_create(int width, int height);
 void board_init(Board *board, const char *cells, bool white_to_move);
 void board_free(Board *board);
 void board_copy(Board *dest, const Board *src);
 
+// Zobrist keys, indexed by bitboard square and piece (b, B, c, C)
+extern uint64_t board_zobrist_pieces[32][4];
+extern uint64_t board_zobrist_black_to_move;
+
+// Piece-square values of the evaluation terms, summed into board->eval by
+// board_set so evaluating a leaf costs O(1). Indexed by term, bitboard
+// square and piece kind (board_piece_kind); values are from black's point
+// of view.
+extern int board_eval_tables[BOARD_EVAL_TERMS][32][BOARD_PIECE_KINDS];
+
+// Replace tables with the ones in a text file (format in eval_tables.txt),
+// false if it cannot be read or is malformed, in which case nothing
+// changes. Load before searching: boards set up earlier keep their old sums
+// until bitboard_sync.
+#define BOARD_EVAL_FILE "eval_tables.txt"
+bool board_eval_load(const char *path);
+
+static inline int board_piece_kind(char piece) {
+    switch (piece) {
+        case 'b': return 0;
+        case 'B': return 1;
+        case 'c': return 2;
+        case 'C': return 3;
+        default: return 4;
+    }
+}
+
+static inline uint64_t board_zobrist_key(int square, char piece) {
+    switch (piece) {
+        case 'b': return board_zobrist_pieces[square][0];
+        case 'B': return board_zobrist_pieces[square][1];
+        case 'c': return board_zobrist_pieces[square][2];
+        case 'C': return board_zobrist_pieces[square][3];
+        default: return 0;
+    }
+}
+
 // Board access helpers (1D array indexing)
 static inline int board_index(const Board *board, int row, int col) {
     return row * board->width + col;
@@ -45,7 +116,36 @@ static inline char board_get(const Board *board, int row, int col) {
 }
 
 static inline void board_set(Board *board, int row, int col, char value) {
+    char previous = board->cells[board_index(board, row, col)];
     board->cells[board_index(board, row, col)] = value;
+    
+    // Only dark squares ((row + col) odd) exist on the bitboard
+    if (board->use_bitboards && ((row + col) & 1)) {
+        int square = row * 4 + col / 2;
+        uint32_t bit = 1u << square;
+        board->white_pieces &= ~bit;
+        board->black_pieces &= ~bit;
+        board->kings &= ~bit;
+        if (value == 'b' || value == 'B') board->white_pieces |= bit;
+        if (value == 'c' || value == 'C') board->black_pieces |= bit;
+        if (value == 'B' || value == 'C') board->kings |= bit;
+        board->hash ^= board_zobrist_key(square, previous) ^ board_zobrist_key(square, value);
+        
+        int before = board_piece_kind(previous);
+        int after = board_piece_kind(value);
+        for (int term = 0; term < BOARD_EVAL_TERMS; term++) {
+            board->eval[term] += board_eval_tables[term][square][after] - board_eval_tables[term][square][before];
+        }
+    }
+}
+
+// Landing square of the given jump of a capture move
+static inline Coordinate board_jump_landing(const Board *board, const Move *move, int jump) {
+    if (move->jumps == 0) {
+        return move->to;
+    }
+    Coordinate coord = {move->path[jump] / board->width, move->path[jump] % board->width};
+    return coord;
 }
 
 // Game logic functions
@@ -54,6 +154,11 @@ void board_find_valid_moves_for_piece(const Board *board, Coordinate coord, bool
 void board_find_capturing_moves(const Board *board, MoveList *pieces);
 void board_generate_all_moves(const Board *board, bool forced_capture, MoveList *moves);
 bool board_apply_move(Board *board, const Move *move);
+bool board_make_move(Board *board, const Move *move, MoveUndo *undo);
+void board_unmake_move(Board *board, const Move *move, const MoveUndo *undo);
+bool board_moves_equal(const Move *a, const Move *b);
+// Cheaper than generating the moves when only their existence matters
+bool board_has_moves(const Board *board);
 bool board_is_game_over(const Board *board);
 void board_find_differences(const Board *current, const Board *previous, MoveList *differences);
 
@@ -0,0 +1,125 @@
+#define _POSIX_C_SOURCE 200809L  // mmap
+
+#include "book.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct OpeningBook {
+    const uint8_t *data;
+    size_t size;
+    const BookEntry *entries;
+    uint64_t count;
+};
+
+OpeningBook* book_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BookHeader)) {
+        close(fd);
+        return NULL;
+    }
+    
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    
+    OpeningBook *book = (OpeningBook*)calloc(1, sizeof(OpeningBook));
+    if (!book) {
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    book->data = (const uint8_t*)data;
+    book->size = (size_t)st.st_size;
+    
+    const BookHeader *header = (const BookHeader*)data;
+    bool valid = memcmp(header->magic, BOOK_MAGIC, 4) == 0 &&
+                 header->version == BOOK_VERSION &&
+                 header->entries <= (book->size - sizeof(BookHeader)) / sizeof(BookEntry);
+    if (!valid) {
+        book_close(book);
+        return NULL;
+    }
+    
+    book->entries = (const BookEntry*)(book->data + sizeof(BookHeader));
+    book->count = header->entries;
+    return book;
+}
+
+void book_close(OpeningBook *book) {
+    if (!book) return;
+    munmap((void*)book->data, book->size);
+    free(book);
+}
+
+uint64_t book_size(const OpeningBook *book) {
+    return book->count;
+}
+
+// Index of the first entry with a hash not below `hash`
+static uint64_t lower_bound(const OpeningBook *book, uint64_t hash) {
+    uint64_t low = 0;
+    uint64_t high = book->count;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (book->entries[middle].hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Legal move of `moves` stored in `entry`, NULL if there is none (a hash
+// collision or a book built for the other capture rule)
+static const Move *entry_move(const Board *board, const MoveList *moves, const BookEntry *entry) {
+    for (int i = 0; i < moves->count; i++) {
+        const Move *move = &moves->moves[i];
+        if (board_index(board, move->from.row, move->from.col) == entry->from &&
+            board_index(board, move->to.row, move->to.col) == entry->to) {
+            return move;
+        }
+    }
+    return NULL;
+}
+
+bool book_probe(const OpeningBook *book, const Board *board, bool forced_capture, uint32_t random, Move *move) {
+    if (!book || !board->use_bitboards) return false;
+    
+    uint64_t first = lower_bound(book, board->hash);
+    uint64_t last = first;
+    while (last < book->count && book->entries[last].hash == board->hash) {
+        last++;
+    }
+    if (first == last) return false;
+    
+    MoveList moves;
+    board_generate_all_moves(board, forced_capture, &moves);
+    
+    uint64_t total = 0;
+    for (uint64_t i = first; i < last; i++) {
+        if (entry_move(board, &moves, &book->entries[i])) {
+            total += book->entries[i].weight;
+        }
+    }
+    if (total == 0) return false;
+    
+    // Entries are ordered by falling weight, so 0 lands on the heaviest
+    uint64_t target = random % total;
+    for (uint64_t i = first; i < last; i++) {
+        const Move *candidate = entry_move(board, &moves, &book->entries[i]);
+        if (!candidate) continue;
+        if (target < book->entries[i].weight) {
+            *move = *candidate;
+            return true;
+        }
+        target -= book->entries[i].weight;
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include "board.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Opening book: moves for the well-known first plies of a game, built
+// offline by bookgen from game records or deep searches and looked up at
+// runtime from a memory-mapped file instead of searching.
+//
+// The file is a header followed by entries sorted by the position's Zobrist
+// hash; entries of the same position are ordered by falling weight. Moves
+// are stored like the transposition table's best move, as the cell indices
+// of their start and end square, and are only played if a legal move of the
+// position matches them.
+
+#define BOOK_FILE "opening.book"
+
+typedef struct OpeningBook OpeningBook;
+
+// Map a book file, NULL if it is missing or invalid
+OpeningBook* book_open(const char *path);
+void book_close(OpeningBook *book);
+
+uint64_t book_size(const OpeningBook *book);  // entries
+
+// Pick a book move for `board`, false if the position is not in the book.
+// Moves are chosen with a probability proportional to their weight, using
+// `random` (e.g. rand()); 0 always picks the heaviest move.
+bool book_probe(const OpeningBook *book, const Board *board, bool forced_capture, uint32_t random, Move *move);
+
+// File layout written by bookgen and read by book_open
+#define BOOK_MAGIC "CKBK"
+#define BOOK_VERSION 1
+
+typedef struct BookHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t entries;
+} BookHeader;
+
+typedef struct BookEntry {
+    uint64_t hash;
+    uint32_t weight;
+    uint8_t from;       // board_index of the start square
+    uint8_t to;         // board_index of the end square
+    uint16_t reserved;
+} BookEntry;
+
+#endif
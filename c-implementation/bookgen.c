@@ -0,0 +1,333 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include "ai.h"
+#include "board.h"
+#include "book.h"
+#include "fen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Opening book builder. Entries come from two sources, which can be
+// combined in one book:
+//   - game records: every move of the first plies of each game adds 1 to
+//     the weight of its (position, move) entry, so popular moves weigh most
+//   - offline search: from the start position every move is searched to a
+//     fixed depth; the best `width` moves within `margin` of the best score
+//     enter the book (the best with weight `width`, the next `width - 1`,
+//     ...) and their positions are expanded in turn up to the ply limit
+// Entries of the same position and move are merged by adding the weights.
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+#define LINE_LENGTH 8192
+#define SEPARATORS " \t\r\n"
+
+typedef struct GenOptions {
+    const char *output;
+    const char *games;      // NULL: no game records
+    int search_depth;       // 0: no search
+    int plies;
+    int width;
+    int margin;
+    int tt_size_mb;
+    bool forced_capture;
+} GenOptions;
+
+typedef struct EntryList {
+    BookEntry *entries;
+    size_t count;
+    size_t capacity;
+} EntryList;
+
+// Positions already expanded by the search, open addressing on the hash
+typedef struct HashSet {
+    uint64_t *keys;         // 0 marks a free slot
+    size_t capacity;        // power of two
+    size_t count;
+} HashSet;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void *checked_realloc(void *data, size_t size) {
+    data = realloc(data, size);
+    if (!data) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    return data;
+}
+
+static void add_entry(EntryList *list, const Board *board, const Move *move, uint32_t weight) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 1024;
+        list->entries = (BookEntry*)checked_realloc(list->entries, list->capacity * sizeof(BookEntry));
+    }
+    BookEntry *entry = &list->entries[list->count++];
+    memset(entry, 0, sizeof(BookEntry));
+    entry->hash = board->hash;
+    entry->weight = weight;
+    entry->from = (uint8_t)board_index(board, move->from.row, move->from.col);
+    entry->to = (uint8_t)board_index(board, move->to.row, move->to.col);
+}
+
+// False if the hash was in the set already
+static bool hash_set_insert(HashSet *set, uint64_t key) {
+    if (key == 0) key = 1;
+    if (2 * (set->count + 1) > set->capacity) {
+        HashSet grown = {NULL, set->capacity ? set->capacity * 2 : 1024, 0};
+        grown.keys = (uint64_t*)checked_realloc(NULL, grown.capacity * sizeof(uint64_t));
+        memset(grown.keys, 0, grown.capacity * sizeof(uint64_t));
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->keys[i]) hash_set_insert(&grown, set->keys[i]);
+        }
+        free(set->keys);
+        *set = grown;
+    }
+    
+    size_t slot = (size_t)key & (set->capacity - 1);
+    while (set->keys[slot]) {
+        if (set->keys[slot] == key) return false;
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    set->keys[slot] = key;
+    set->count++;
+    return true;
+}
+
+// Add the first plies of every game in the file, one game per line as moves
+// from the start position ("22-18 11-15 18x11 8x15 ..."). Move numbers ("1.") are
+// skipped; a game ends at the first token that is not a legal move, such as
+// a result.
+static bool add_games(const GenOptions *options, Board *board, EntryList *list) {
+    FILE *file = fopen(options->games, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", options->games);
+        return false;
+    }
+    
+    char line[LINE_LENGTH];
+    int games = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+    
+        fen_parse(board, FEN_START);
+        int ply = 0;
+        char *save = NULL;
+        for (char *token = strtok_r(line, SEPARATORS, &save); token && ply < options->plies;
+             token = strtok_r(NULL, SEPARATORS, &save)) {
+            if (token[strlen(token) - 1] == '.') continue;
+    
+            Move move;
+            if (!fen_parse_move(board, token, options->forced_capture, &move)) break;
+            add_entry(list, board, &move, 1);
+            board_apply_move(board, &move);
+            ply++;
+        }
+        games += ply > 0;
+    }
+    fclose(file);
+    
+    fprintf(stderr, "Read %d games from %s\n", games, options->games);
+    return true;
+}
+
+typedef struct ScoredMove {
+    int index;
+    Score score;            // for the side to move
+} ScoredMove;
+
+static int compare_scored(const void *a, const void *b) {
+    const ScoredMove *x = (const ScoredMove*)a;
+    const ScoredMove *y = (const ScoredMove*)b;
+    if (x->score != y->score) return x->score > y->score ? -1 : 1;
+    return x->index - y->index;  // generator order among equal scores
+}
+
+// Search every move of the position on `board` and expand the best ones
+static void expand(SearchContext *ctx, const GenOptions *options, Board *board, int ply,
+                   EntryList *list, HashSet *expanded, int *searched) {
+    if (ply >= options->plies || !hash_set_insert(expanded, board->hash)) return;
+    
+    MoveList moves;
+    board_generate_all_moves(board, options->forced_capture, &moves);
+    
+    // Scores are from black's point of view, sorted for the side to move
+    ScoredMove scored[MAX_MOVES];
+    for (int i = 0; i < moves.count; i++) {
+        MoveUndo undo;
+        board_make_move(board, &moves.moves[i], &undo);
+        Score score = moves.count == 1 ? 0 :
+                      ai_alpha_beta(ctx, board, options->search_depth - 1, -SCORE_INFINITE, SCORE_INFINITE,
+                                    !board->white_to_move, options->forced_capture, evaluate_standard);
+        board_unmake_move(board, &moves.moves[i], &undo);
+        scored[i] = (ScoredMove){i, board->white_to_move ? -score : score};
+    }
+    qsort(scored, (size_t)moves.count, sizeof(ScoredMove), compare_scored);
+    (*searched)++;
+    
+    for (int rank = 0; rank < moves.count && rank < options->width; rank++) {
+        if (scored[0].score - scored[rank].score > options->margin) break;
+    
+        const Move *move = &moves.moves[scored[rank].index];
+        add_entry(list, board, move, (uint32_t)(options->width - rank));
+    
+        MoveUndo undo;
+        board_make_move(board, move, &undo);
+        expand(ctx, options, board, ply + 1, list, expanded, searched);
+        board_unmake_move(board, move, &undo);
+    }
+}
+
+static int compare_position_move(const void *a, const void *b) {
+    const BookEntry *x = (const BookEntry*)a;
+    const BookEntry *y = (const BookEntry*)b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    if (x->from != y->from) return x->from - y->from;
+    return x->to - y->to;
+}
+
+// Book order: by position, then heaviest move first
+static int compare_book_order(const void *a, const void *b) {
+    const BookEntry *x = (const BookEntry*)a;
+    const BookEntry *y = (const BookEntry*)b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    if (x->weight != y->weight) return x->weight > y->weight ? -1 : 1;
+    return compare_position_move(a, b);
+}
+
+// Merge duplicate entries and sort the list into book order
+static void finish_entries(EntryList *list) {
+    if (list->count == 0) return;
+    qsort(list->entries, list->count, sizeof(BookEntry), compare_position_move);
+    
+    size_t kept = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        BookEntry *last = kept > 0 ? &list->entries[kept - 1] : NULL;
+        if (last && compare_position_move(last, &list->entries[i]) == 0) {
+            uint64_t weight = (uint64_t)last->weight + list->entries[i].weight;
+            last->weight = weight > UINT32_MAX ? UINT32_MAX : (uint32_t)weight;
+        } else {
+            list->entries[kept++] = list->entries[i];
+        }
+    }
+    list->count = kept;
+    qsort(list->entries, list->count, sizeof(BookEntry), compare_book_order);
+}
+
+static bool write_book(const GenOptions *options, const EntryList *list) {
+    FILE *file = fopen(options->output, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", options->output);
+        return false;
+    }
+    
+    BookHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BOOK_MAGIC, 4);
+    header.version = BOOK_VERSION;
+    header.entries = list->count;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(list->entries, sizeof(BookEntry), list->count, file);
+    
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "Error writing %s\n", options->output);
+    }
+    return ok;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --games FILE     game records, one game per line as moves from the start position\n"
+            "  --search DEPTH   add lines found by searching every move to DEPTH\n"
+            "  --plies N        book length in plies from the start position (default 10)\n"
+            "  --width N        moves kept per position by --search (default 2)\n"
+            "  --margin SCORE   keep only moves this close to the best score (default 20)\n"
+            "  --tt MB          transposition table for --search (default 64)\n"
+            "  --output FILE    book file (default %s)\n"
+            "  --no-forced      captures are optional\n",
+            program, BOOK_FILE);
+}
+
+int main(int argc, char *argv[]) {
+    GenOptions options = {BOOK_FILE, NULL, 0, 10, 2, 20, 64, true};
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+    
+        if (strcmp(arg, "--games") == 0 && has_value) {
+            options.games = argv[++i];
+        } else if (strcmp(arg, "--search") == 0 && has_value) {
+            options.search_depth = atoi(argv[++i]);
+        } else if (strcmp(arg, "--plies") == 0 && has_value) {
+            options.plies = atoi(argv[++i]);
+        } else if (strcmp(arg, "--width") == 0 && has_value) {
+            options.width = atoi(argv[++i]);
+        } else if (strcmp(arg, "--margin") == 0 && has_value) {
+            options.margin = atoi(argv[++i]);
+        } else if (strcmp(arg, "--tt") == 0 && has_value) {
+            options.tt_size_mb = atoi(argv[++i]);
+        } else if (strcmp(arg, "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else if (strcmp(arg, "--no-forced") == 0) {
+            options.forced_capture = false;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if ((!options.games && options.search_depth < 1) || options.plies < 1 || options.width < 1 ||
+        options.margin < 0 || options.search_depth < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    SearchContext *ctx = ai_context_create();
+    if (!board || !ctx) {
+        fprintf(stderr, "Failed to create board!\n");
+        return 1;
+    }
+    board_eval_load(BOARD_EVAL_FILE);
+    
+    EntryList list = {NULL, 0, 0};
+    double start = now_ms();
+    bool ok = !options.games || add_games(&options, board, &list);
+    
+    TranspositionTable *tt = NULL;
+    if (ok && options.search_depth > 0) {
+        tt = options.tt_size_mb > 0 ? tt_create((size_t)options.tt_size_mb) : NULL;
+        ai_set_transposition_table(ctx, tt);
+    
+        HashSet expanded = {NULL, 0, 0};
+        int searched = 0;
+        fen_parse(board, FEN_START);
+        expand(ctx, &options, board, 0, &list, &expanded, &searched);
+        free(expanded.keys);
+        fprintf(stderr, "Searched %d positions to depth %d\n", searched, options.search_depth);
+    }
+    
+    if (ok) {
+        finish_entries(&list);
+        ok = write_book(&options, &list);
+    }
+    if (ok) {
+        fprintf(stderr, "Wrote %zu entries to %s in %.1fs\n", list.count, options.output, (now_ms() - start) / 1000.0);
+    }
+    
+    free(list.entries);
+    tt_free(tt);
+    ai_context_free(ctx);
+    board_free(board);
+    return ok ? 0 : 1;
+}
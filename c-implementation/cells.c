@@ -0,0 +1,148 @@
+#include "cells.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CELLS_X86
+#include <immintrin.h>
+#endif
+
+static void count_scalar(const char *cells, int size, CellCounts *counts) {
+    int white_men = 0, white_kings = 0, black_men = 0, black_kings = 0;
+    
+    for (int i = 0; i < size; i++) {
+        char cell = cells[i];
+        white_men += cell == 'b';
+        white_kings += cell == 'B';
+        black_men += cell == 'c';
+        black_kings += cell == 'C';
+    }
+    counts->pieces[0] = white_men;
+    counts->pieces[1] = white_kings;
+    counts->pieces[2] = black_men;
+    counts->pieces[3] = black_kings;
+}
+
+#ifdef CELLS_X86
+// Vector kernels: one compare per piece and block of 16 or 32 cells. They
+// return the number of cells covered; their callers count the rest with the scalar loop, outside the
+// target functions so no SSE code runs with the upper AVX state dirty.
+// SSE2 has no popcount: matches are counted per byte lane (a compare gives
+// -1) and the lanes summed with psadbw before they can overflow
+__attribute__((target("sse2")))
+static int count_blocks_sse2(const char *cells, int size, int totals[4]) {
+    const __m128i pieces[4] = {_mm_set1_epi8('b'), _mm_set1_epi8('B'), _mm_set1_epi8('c'), _mm_set1_epi8('C')};
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    
+    while (i + 16 <= size) {
+        __m128i lanes[4] = {zero, zero, zero, zero};
+        for (int blocks = 0; blocks < 255 && i + 16 <= size; blocks++, i += 16) {
+            __m128i block = _mm_loadu_si128((const __m128i*)(cells + i));
+            for (int p = 0; p < 4; p++) {
+                lanes[p] = _mm_sub_epi8(lanes[p], _mm_cmpeq_epi8(block, pieces[p]));
+            }
+        }
+        for (int p = 0; p < 4; p++) {
+            __m128i sums = _mm_sad_epu8(lanes[p], zero);
+            totals[p] += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+        }
+    }
+    return i;
+}
+
+// AVX2 machines all have popcnt, which counts the byte mask of the matches
+__attribute__((target("avx2,popcnt")))
+static int count_blocks_avx2(const char *cells, int size, int totals[4]) {
+    const __m256i white_men = _mm256_set1_epi8('b');
+    const __m256i white_kings = _mm256_set1_epi8('B');
+    const __m256i black_men = _mm256_set1_epi8('c');
+    const __m256i black_kings = _mm256_set1_epi8('C');
+    int i = 0;
+    
+    for (; i + 32 <= size; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(cells + i));
+        totals[0] += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, white_men)));
+        totals[1] += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, white_kings)));
+        totals[2] += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, black_men)));
+        totals[3] += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, black_kings)));
+    }
+    return i;
+}
+
+static void count_with_blocks(int (*blocks)(const char*, int, int[4]), const char *cells, int size, CellCounts *counts) {
+    int totals[4] = {0, 0, 0, 0};
+    int done = blocks(cells, size, totals);
+    
+    count_scalar(cells + done, size - done, counts);
+    for (int p = 0; p < 4; p++) {
+        counts->pieces[p] += totals[p];
+    }
+}
+
+static void count_sse2(const char *cells, int size, CellCounts *counts) {
+    count_with_blocks(count_blocks_sse2, cells, size, counts);
+}
+
+static void count_avx2(const char *cells, int size, CellCounts *counts) {
+    count_with_blocks(count_blocks_avx2, cells, size, counts);
+}
+#endif
+
+typedef void (*CountFunc)(const char *cells, int size, CellCounts *counts);
+
+static CountFunc count_funcs[CELLS_BACKENDS] = {
+    count_scalar,
+#ifdef CELLS_X86
+    count_sse2,
+    count_avx2,
+#endif
+};
+
+static const char *const backend_names[CELLS_BACKENDS] = {"scalar", "sse2", "avx2"};
+
+// Resolved on first use; threads racing here all store the same values
+static CountFunc count_func = NULL;
+static CellsBackend current_backend = CELLS_SCALAR;
+
+bool cells_backend_supported(CellsBackend backend) {
+    if (backend < 0 || backend >= CELLS_BACKENDS || !count_funcs[backend]) {
+        return false;
+    }
+#ifdef CELLS_X86
+    __builtin_cpu_init();
+    if (backend == CELLS_SSE2) return __builtin_cpu_supports("sse2");
+    if (backend == CELLS_AVX2) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+    return true;
+}
+
+CellsBackend cells_backend(void) {
+    if (!count_func) {
+        CellsBackend best = CELLS_SCALAR;
+        for (int b = CELLS_SCALAR + 1; b < CELLS_BACKENDS; b++) {
+            if (cells_backend_supported((CellsBackend)b)) best = (CellsBackend)b;
+        }
+        current_backend = best;
+        count_func = count_funcs[best];
+    }
+    return current_backend;
+}
+
+bool cells_set_backend(CellsBackend backend) {
+    if (!cells_backend_supported(backend)) {
+        return false;
+    }
+    current_backend = backend;
+    count_func = count_funcs[backend];
+    return true;
+}
+
+const char* cells_backend_name(CellsBackend backend) {
+    return backend >= 0 && backend < CELLS_BACKENDS ? backend_names[backend] : "unknown";
+}
+
+void cells_count(const char *cells, int size, CellCounts *counts) {
+    if (!count_func) {
+        cells_backend();
+    }
+    count_func(cells, size, counts);
+}
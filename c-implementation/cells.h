@@ -0,0 +1,32 @@
+#ifndef CELLS_H
+#define CELLS_H
+
+#include <stdbool.h>
+
+// Piece counts over a board's cell array, used where no bitboards exist
+// (board sizes other than 8x8). The scan compares 16 or 32 cells at once
+// with SSE2 or AVX2 when the CPU supports them; the fastest supported path
+// is picked at runtime and the scalar loop is the fallback.
+
+typedef enum CellsBackend {
+    CELLS_SCALAR,
+    CELLS_SSE2,
+    CELLS_AVX2,
+    CELLS_BACKENDS
+} CellsBackend;
+
+// Number of cells holding each piece, indexed like board_piece_kind:
+// b, B, c, C
+typedef struct CellCounts {
+    int pieces[4];
+} CellCounts;
+
+void cells_count(const char *cells, int size, CellCounts *counts);
+
+CellsBackend cells_backend(void);
+bool cells_backend_supported(CellsBackend backend);
+// Force a path (for benchmarks), false if the CPU does not support it
+bool cells_set_backend(CellsBackend backend);
+const char* cells_backend_name(CellsBackend backend);
+
+#endif
@@ -0,0 +1,275 @@
+#define _POSIX_C_SOURCE 200809L  // mmap
+
+#include "endgame.h"
+#include "bitboard.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAN_SQUARES 28
+#define WHITE_MAN_SHIFT 4  // white men never stand on row 0, black men never on row 7
+
+struct EndgameTable {
+    const uint8_t *data;
+    size_t size;
+    int max_pieces;
+    uint32_t flags;
+    // Slice of every piece count combination, NULL if not in the file
+    const EndgameSlice *slices[ENDGAME_MAX_PIECES + 1][ENDGAME_MAX_PIECES + 1]
+                              [ENDGAME_MAX_PIECES + 1][ENDGAME_MAX_PIECES + 1];
+};
+
+static uint64_t binomial[BB_SQUARES + 1][ENDGAME_MAX_PIECES + 1];
+static bool binomial_ready = false;
+
+static void binomial_init(void) {
+    if (binomial_ready) return;
+    
+    for (int n = 0; n <= BB_SQUARES; n++) {
+        binomial[n][0] = 1;
+        for (int k = 1; k <= ENDGAME_MAX_PIECES; k++) {
+            binomial[n][k] = n == 0 ? 0 : binomial[n - 1][k - 1] + binomial[n - 1][k];
+        }
+    }
+    binomial_ready = true;
+}
+
+// Combinatorial rank of a set of positions: sum of C(position, i) over the
+// positions in ascending order, i counting from 1
+static uint64_t rank_set(uint32_t set) {
+    uint64_t rank = 0;
+    for (int i = 1; set; set &= set - 1, i++) {
+        rank += binomial[bitboard_lowest(set)][i];
+    }
+    return rank;
+}
+
+static uint32_t unrank_set(uint64_t rank, int count) {
+    uint32_t set = 0;
+    int position = BB_SQUARES - 1;
+    
+    for (int i = count; i > 0; i--) {
+        while (binomial[position][i] > rank) {
+            position--;
+        }
+        set |= 1u << position;
+        rank -= binomial[position][i];
+        position--;
+    }
+    return set;
+}
+
+// Positions of `squares` counted over the free squares only
+static uint32_t compress(uint32_t squares, uint32_t free) {
+    uint32_t set = 0;
+    for (; squares; squares &= squares - 1) {
+        int square = bitboard_lowest(squares);
+        set |= 1u << bitboard_popcount(free & ((1u << square) - 1));
+    }
+    return set;
+}
+
+static uint32_t expand(uint32_t set, uint32_t free) {
+    uint32_t squares = 0;
+    int position = 0;
+    for (; free; free &= free - 1, position++) {
+        if (set & (1u << position)) {
+            squares |= free & -free;
+        }
+    }
+    return squares;
+}
+
+uint64_t endgame_slice_size(int white_men, int white_kings, int black_men, int black_kings) {
+    binomial_init();
+    int free = BB_SQUARES - white_men - black_men;
+    return binomial[MAN_SQUARES][white_men] * binomial[MAN_SQUARES][black_men] *
+           binomial[free][white_kings] * binomial[free - white_kings][black_kings] * 2;
+}
+
+uint64_t endgame_index(const Board *board) {
+    binomial_init();
+    
+    uint32_t white_men = board->white_pieces & ~board->kings;
+    uint32_t black_men = board->black_pieces & ~board->kings;
+    uint32_t white_kings = board->white_pieces & board->kings;
+    uint32_t black_kings = board->black_pieces & board->kings;
+    int black_man_count = bitboard_popcount(black_men);
+    int white_king_count = bitboard_popcount(white_kings);
+    int black_king_count = bitboard_popcount(black_kings);
+    
+    uint32_t free = ~(white_men | black_men);
+    int free_count = bitboard_popcount(free);
+    
+    uint64_t index = rank_set(white_men >> WHITE_MAN_SHIFT);
+    index = index * binomial[MAN_SQUARES][black_man_count] + rank_set(black_men);
+    index = index * binomial[free_count][white_king_count] + rank_set(compress(white_kings, free));
+    free &= ~white_kings;
+    index = index * binomial[free_count - white_king_count][black_king_count] + rank_set(compress(black_kings, free));
+    return index * 2 + !board->white_to_move;
+}
+
+bool endgame_position(Board *board, int white_men, int white_kings, int black_men, int black_kings, uint64_t index) {
+    binomial_init();
+    
+    bool white_to_move = (index & 1) == 0;
+    index /= 2;
+    
+    int free_count = BB_SQUARES - white_men - black_men;
+    uint64_t black_king_size = binomial[free_count - white_kings][black_kings];
+    uint64_t white_king_size = binomial[free_count][white_kings];
+    uint64_t black_man_size = binomial[MAN_SQUARES][black_men];
+    
+    uint32_t black_king_set = unrank_set(index % black_king_size, black_kings);
+    index /= black_king_size;
+    uint32_t white_king_set = unrank_set(index % white_king_size, white_kings);
+    index /= white_king_size;
+    uint32_t black_man_squares = unrank_set(index % black_man_size, black_men);
+    index /= black_man_size;
+    uint32_t white_man_squares = unrank_set(index, white_men) << WHITE_MAN_SHIFT;
+    
+    if (white_man_squares & black_man_squares) {
+        return false;
+    }
+    
+    uint32_t free = ~(white_man_squares | black_man_squares);
+    uint32_t white_king_squares = expand(white_king_set, free);
+    uint32_t black_king_squares = expand(black_king_set, free & ~white_king_squares);
+    
+    // Empty the board, then place the pieces
+    for (uint32_t squares = board->white_pieces | board->black_pieces; squares; squares &= squares - 1) {
+        Coordinate coord = bitboard_coordinate(bitboard_lowest(squares));
+        board_set(board, coord.row, coord.col, '.');
+    }
+    if (board->white_to_move != white_to_move) {
+        board->white_to_move = white_to_move;
+        board->hash ^= board_zobrist_black_to_move;
+    }
+    board->game_end = false;
+    
+    const uint32_t groups[4] = {white_man_squares, white_king_squares, black_man_squares, black_king_squares};
+    const char pieces[4] = {'b', 'B', 'c', 'C'};
+    for (int g = 0; g < 4; g++) {
+        for (uint32_t squares = groups[g]; squares; squares &= squares - 1) {
+            Coordinate coord = bitboard_coordinate(bitboard_lowest(squares));
+            board_set(board, coord.row, coord.col, pieces[g]);
+        }
+    }
+    return true;
+}
+
+EndgameTable* endgame_open(const char *path) {
+    binomial_init();
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EndgameHeader)) {
+        close(fd);
+        return NULL;
+    }
+    
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    
+    EndgameTable *table = (EndgameTable*)calloc(1, sizeof(EndgameTable));
+    if (!table) {
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    table->data = (const uint8_t*)data;
+    table->size = (size_t)st.st_size;
+    
+    const EndgameHeader *header = (const EndgameHeader*)data;
+    const EndgameSlice *slices = (const EndgameSlice*)(table->data + sizeof(EndgameHeader));
+    bool valid = memcmp(header->magic, ENDGAME_MAGIC, 4) == 0 &&
+                 header->version == ENDGAME_VERSION &&
+                 header->max_pieces <= ENDGAME_MAX_PIECES &&
+                 sizeof(EndgameHeader) + header->slice_count * sizeof(EndgameSlice) <= table->size;
+    
+    for (uint32_t i = 0; valid && i < header->slice_count; i++) {
+        const EndgameSlice *slice = &slices[i];
+        uint64_t bytes = header->flags & ENDGAME_FLAG_DISTANCE ? slice->entries : (slice->entries + 3) / 4;
+    
+        valid = slice->white_men + slice->white_kings + slice->black_men + slice->black_kings <= (int)header->max_pieces &&
+                slice->entries == endgame_slice_size(slice->white_men, slice->white_kings, slice->black_men, slice->black_kings) &&
+                slice->offset + bytes <= table->size;
+        if (valid) {
+            table->slices[slice->white_men][slice->white_kings][slice->black_men][slice->black_kings] = slice;
+        }
+    }
+    
+    if (!valid) {
+        endgame_close(table);
+        return NULL;
+    }
+    
+    table->max_pieces = (int)header->max_pieces;
+    table->flags = header->flags;
+    return table;
+}
+
+void endgame_close(EndgameTable *table) {
+    if (!table) return;
+    munmap((void*)table->data, table->size);
+    free(table);
+}
+
+int endgame_max_pieces(const EndgameTable *table) {
+    return table->max_pieces;
+}
+
+bool endgame_forced_capture(const EndgameTable *table) {
+    return (table->flags & ENDGAME_FLAG_FORCED) != 0;
+}
+
+bool endgame_has_distance(const EndgameTable *table) {
+    return (table->flags & ENDGAME_FLAG_DISTANCE) != 0;
+}
+
+bool endgame_probe(const EndgameTable *table, const Board *board, EndgameResult *result) {
+    if (!board->use_bitboards) return false;
+    
+    uint32_t own = board->white_to_move ? board->white_pieces : board->black_pieces;
+    if (own == 0) {
+        result->value = -1;  // nothing left to move
+        result->distance = 0;
+        return true;
+    }
+    
+    int white_kings = bitboard_popcount(board->white_pieces & board->kings);
+    int black_kings = bitboard_popcount(board->black_pieces & board->kings);
+    int white_men = bitboard_popcount(board->white_pieces) - white_kings;
+    int black_men = bitboard_popcount(board->black_pieces) - black_kings;
+    if (white_men + white_kings + black_men + black_kings > table->max_pieces) {
+        return false;
+    }
+    
+    const EndgameSlice *slice = table->slices[white_men][white_kings][black_men][black_kings];
+    if (!slice) return false;
+    
+    // Men on their promotion row have no index (see WHITE_MAN_SHIFT)
+    uint32_t men = ~board->kings;
+    if ((board->white_pieces & men & BB_TOP_ROW) || (board->black_pieces & men & BB_BOTTOM_ROW)) {
+        return false;
+    }
+    
+    uint64_t index = endgame_index(board);
+    if (index >= slice->entries) return false;
+    const uint8_t *data = table->data + slice->offset;
+    
+    if (table->flags & ENDGAME_FLAG_DISTANCE) {
+        *result = endgame_decode(data[index]);
+    } else {
+        // 2 bits per position: 0 draw, 1 win, 2 loss
+        int wdl = (data[index / 4] >> (2 * (index % 4))) & 3;
+        result->value = wdl == 1 ? 1 : (wdl == 2 ? -1 : 0);
+        result->distance = -1;
+    }
+    return true;
+}
@@ -0,0 +1,95 @@
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include "board.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Endgame tables: the game-theoretic value of every 8x8 position with at
+// most ENDGAME_MAX_PIECES pieces, computed offline by tbgen and probed at
+// runtime from a memory-mapped file.
+//
+// Positions are grouped in slices by piece counts (white men, white kings,
+// black men, black kings). Inside a slice the index is built from the
+// combinatorial rank of each piece group: men over the 28 squares they can
+// stand on, then white and black kings over the squares left free.
+
+#define ENDGAME_MAX_PIECES 6
+#define ENDGAME_FILE "endgame.tb"
+
+// One byte per position in distance files: 0 is a draw, 1..127 a win for
+// the side to move in that many plies, 128 + n a loss in n plies. Distances
+// saturate at 127. Files without distances pack 2 bits per position.
+#define ENDGAME_DRAW 0
+#define ENDGAME_MAX_DISTANCE 127
+#define ENDGAME_LOSS_BASE 128
+
+typedef struct EndgameTable EndgameTable;
+
+typedef struct EndgameResult {
+    int value;      // 1 win, 0 draw, -1 loss, for the side to move
+    int distance;   // plies to the end of the game, -1 if the file has none
+} EndgameResult;
+
+// Map a table file, NULL if it is missing or invalid
+EndgameTable* endgame_open(const char *path);
+void endgame_close(EndgameTable *table);
+
+int endgame_max_pieces(const EndgameTable *table);
+bool endgame_forced_capture(const EndgameTable *table);
+bool endgame_has_distance(const EndgameTable *table);
+
+// False if the position is not covered by the table, or cannot be indexed
+// because a man stands on its promotion row
+bool endgame_probe(const EndgameTable *table, const Board *board, EndgameResult *result);
+
+// Indexing, shared with the generator
+uint64_t endgame_slice_size(int white_men, int white_kings, int black_men, int black_kings);
+uint64_t endgame_index(const Board *board);
+// Place the pieces of `index` on an empty 8x8 board, false for an index
+// whose men overlap (such entries are never probed)
+bool endgame_position(Board *board, int white_men, int white_kings, int black_men, int black_kings, uint64_t index);
+
+// File layout written by tbgen and read by endgame_open
+#define ENDGAME_MAGIC "CKEG"
+#define ENDGAME_VERSION 1
+#define ENDGAME_FLAG_FORCED   1u  // generated with forced captures
+#define ENDGAME_FLAG_DISTANCE 2u  // one byte per position instead of 2 bits
+
+typedef struct EndgameHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t max_pieces;
+    uint32_t flags;
+    uint32_t slice_count;
+    uint32_t reserved;
+} EndgameHeader;
+
+typedef struct EndgameSlice {
+    uint8_t white_men, white_kings, black_men, black_kings;
+    uint32_t reserved;
+    uint64_t offset;    // from the start of the file
+    uint64_t entries;
+} EndgameSlice;
+
+// Value and distance of a distance byte
+static inline EndgameResult endgame_decode(uint8_t entry) {
+    EndgameResult result = {0, 0};
+    if (entry >= ENDGAME_LOSS_BASE) {
+        result.value = -1;
+        result.distance = entry - ENDGAME_LOSS_BASE;
+    } else if (entry != ENDGAME_DRAW) {
+        result.value = 1;
+        result.distance = entry;
+    }
+    return result;
+}
+
+static inline uint8_t endgame_encode(int value, int distance) {
+    if (distance > ENDGAME_MAX_DISTANCE) distance = ENDGAME_MAX_DISTANCE;
+    if (value > 0) return (uint8_t)(distance < 1 ? 1 : distance);
+    if (value < 0) return (uint8_t)(ENDGAME_LOSS_BASE + distance);
+    return ENDGAME_DRAW;
+}
+
+#endif
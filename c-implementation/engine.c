@@ -0,0 +1,346 @@
+#define _POSIX_C_SOURCE 200809L  // pthreads, sysconf, strtok_r
+
+#include "engine.h"
+#include "ai.h"
+#include "book.h"
+#include "fen.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+#define ENGINE_LINE_LENGTH 8192
+#define ENGINE_SEPARATORS " \t\r\n"
+#define ENGINE_MAX_DEPTH 64
+#define ENGINE_MOVE_TIME_MS 1000  // `go` without limits
+
+typedef struct EngineOptions {
+    int threads;
+    int tt_size_mb;
+    bool use_book;
+} EngineOptions;
+
+typedef struct Engine {
+    Board *board;
+    Board *scratch;             // position being set up, copied once valid
+    SearchContext *ctx;
+    TranspositionTable *tt;
+    const OpeningBook *book;    // NULL when missing or disabled
+    bool forced_capture;
+    
+    // Current search, owned by the search thread while `searching`
+    pthread_t thread;
+    bool searching;             // thread started and not joined yet
+    bool finished;              // set by the search thread, under `output`
+    bool infinite;              // bestmove waits for stop
+    int max_depth;
+    int budget_ms;
+    volatile bool stop;
+    SearchResult result;
+    
+    pthread_mutex_t output;     // one writer at a time on stdout
+} Engine;
+
+static void reply(Engine *engine, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    pthread_mutex_lock(&engine->output);
+    vprintf(format, args);
+    putchar('\n');
+    fflush(stdout);
+    pthread_mutex_unlock(&engine->output);
+    va_end(args);
+}
+
+// Caller holds engine->output
+static void print_bestmove(Engine *engine) {
+    char move[MOVE_TEXT_LENGTH] = "none";
+    if (board_has_moves(engine->board)) {
+        fen_format_move(engine->board, &engine->result.best_move, move, sizeof(move));
+    }
+    printf("bestmove %s\n", move);
+    fflush(stdout);
+}
+
+static void *search_thread(void *arg) {
+    Engine *engine = (Engine*)arg;
+    
+    ai_reset_search_stats(engine->ctx);
+    
+    // Book moves are answered without a search (and without info), always
+    // the heaviest one so the engine stays deterministic
+    Move book_move;
+    if (book_probe(engine->book, engine->board, engine->forced_capture, 0, &book_move)) {
+        memset(&engine->result, 0, sizeof(SearchResult));
+        engine->result.best_move = book_move;
+    } else {
+        engine->result = ai_search_timed(engine->ctx, engine->board, engine->budget_ms, engine->max_depth,
+                                         engine->forced_capture, ai_default_evaluation(engine->board));
+    }
+    SearchStats stats;
+    ai_get_search_stats(engine->ctx, &stats);
+    
+    // Finished together with the move: a client answering bestmove
+    // right away finds the engine idle
+    pthread_mutex_lock(&engine->output);
+    if (engine->result.depth > 0) {
+        printf("info depth %d score %d nodes %llu time %.0f\n", engine->result.depth,
+               (int)engine->result.score, stats.nodes, engine->result.time_ms);
+    }
+    if (!engine->infinite) {
+        print_bestmove(engine);
+    }
+    fflush(stdout);
+    engine->finished = true;
+    pthread_mutex_unlock(&engine->output);
+    return NULL;
+}
+
+// Abort the running search and wait for it; an infinite search reports
+// its move now
+static void engine_stop(Engine *engine) {
+    if (!engine->searching) return;
+    
+    engine->stop = true;
+    pthread_join(engine->thread, NULL);
+    engine->searching = false;
+    if (engine->infinite) {
+        pthread_mutex_lock(&engine->output);
+        print_bestmove(engine);
+        pthread_mutex_unlock(&engine->output);
+    }
+}
+
+// True while a search still owns the board. A search that has already
+// reported its move is joined here.
+static bool engine_busy(Engine *engine) {
+    if (!engine->searching) return false;
+    
+    pthread_mutex_lock(&engine->output);
+    bool finished = engine->finished && !engine->infinite;
+    pthread_mutex_unlock(&engine->output);
+    if (finished) {
+        pthread_join(engine->thread, NULL);
+        engine->searching = false;
+    }
+    return engine->searching;
+}
+
+static void command_position(Engine *engine, char **save) {
+    const char *kind = strtok_r(NULL, ENGINE_SEPARATORS, save);
+    const char *fen = NULL;
+    if (kind && strcmp(kind, "start") == 0) {
+        fen = FEN_START;
+    } else if (kind && strcmp(kind, "fen") == 0) {
+        fen = strtok_r(NULL, ENGINE_SEPARATORS, save);
+    }
+    if (!fen) {
+        reply(engine, "error expected position start|fen <fen>");
+        return;
+    }
+    if (!fen_parse(engine->scratch, fen)) {
+        reply(engine, "error invalid position %s", fen);
+        return;
+    }
+    
+    const char *token = strtok_r(NULL, ENGINE_SEPARATORS, save);
+    if (token && strcmp(token, "moves") != 0) {
+        reply(engine, "error unexpected %s", token);
+        return;
+    }
+    while (token && (token = strtok_r(NULL, ENGINE_SEPARATORS, save))) {
+        Move move;
+        if (!fen_parse_move(engine->scratch, token, engine->forced_capture, &move)) {
+            reply(engine, "error illegal move %s", token);
+            return;
+        }
+        board_apply_move(engine->scratch, &move);
+    }
+    board_copy(engine->board, engine->scratch);
+}
+
+static void command_go(Engine *engine, char **save) {
+    engine->max_depth = ENGINE_MAX_DEPTH;
+    engine->budget_ms = ENGINE_MOVE_TIME_MS;
+    engine->infinite = false;
+    
+    bool has_depth = false;
+    bool has_movetime = false;
+    const char *token;
+    while ((token = strtok_r(NULL, ENGINE_SEPARATORS, save))) {
+        const char *value = NULL;
+        if (strcmp(token, "infinite") == 0) {
+            engine->infinite = true;
+            continue;
+        }
+        if (strcmp(token, "depth") == 0 || strcmp(token, "movetime") == 0) {
+            value = strtok_r(NULL, ENGINE_SEPARATORS, save);
+        }
+        if (!value || atoi(value) < 1) {
+            reply(engine, "error expected go [depth N] [movetime MS] [infinite]");
+            return;
+        }
+        if (token[0] == 'd') {
+            engine->max_depth = atoi(value);
+            has_depth = true;
+        } else {
+            engine->budget_ms = atoi(value);
+            has_movetime = true;
+        }
+    }
+    
+    // A fixed depth without a movetime, or an infinite search, is only
+    // limited by stop
+    if ((has_depth && !has_movetime) || engine->infinite) {
+        engine->budget_ms = INT_MAX;
+    }
+    
+    engine->stop = false;
+    engine->finished = false;
+    if (pthread_create(&engine->thread, NULL, search_thread, engine) != 0) {
+        reply(engine, "error cannot start the search");
+        return;
+    }
+    engine->searching = true;
+}
+
+// Handle one line, false on quit
+static bool engine_command(Engine *engine, char *line) {
+    char *save = NULL;
+    const char *command = strtok_r(line, ENGINE_SEPARATORS, &save);
+    if (!command) return true;
+    
+    if (strcmp(command, "quit") == 0) {
+        engine_stop(engine);
+        return false;
+    }
+    if (strcmp(command, "isready") == 0) {
+        reply(engine, "readyok");
+        return true;
+    }
+    if (strcmp(command, "stop") == 0) {
+        engine_stop(engine);
+        return true;
+    }
+    
+    if (engine_busy(engine)) {
+        reply(engine, "error search running");
+    } else if (strcmp(command, "newgame") == 0) {
+        if (engine->tt) tt_clear(engine->tt);
+        ai_clear_move_ordering(engine->ctx);
+    } else if (strcmp(command, "position") == 0) {
+        command_position(engine, &save);
+    } else if (strcmp(command, "go") == 0) {
+        command_go(engine, &save);
+    } else if (strcmp(command, "forced") == 0) {
+        const char *value = strtok_r(NULL, ENGINE_SEPARATORS, &save);
+        if (value && (strcmp(value, "on") == 0 || strcmp(value, "off") == 0)) {
+            engine->forced_capture = strcmp(value, "on") == 0;
+        } else {
+            reply(engine, "error expected forced on|off");
+        }
+    } else if (strcmp(command, "stats") == 0) {
+        SearchStats stats;
+        ai_get_search_stats(engine->ctx, &stats);
+        pthread_mutex_lock(&engine->output);
+        printf("stats ");
+        ai_write_search_stats_json(&stats, stdout);
+        putchar('\n');
+        fflush(stdout);
+        pthread_mutex_unlock(&engine->output);
+    } else if (strcmp(command, "fen") == 0) {
+        char fen[FEN_MAX_LENGTH];
+        fen_format(engine->board, fen, sizeof(fen));
+        reply(engine, "fen %s", fen);
+    } else {
+        reply(engine, "error unknown command %s", command);
+    }
+    return true;
+}
+
+static void print_usage(void) {
+    fprintf(stderr,
+            "Usage: checkers --engine [options]\n"
+            "  --threads N      search threads (default: one per core)\n"
+            "  --tt MB          transposition table size, 0 disables it (default 64)\n"
+            "  --no-book        search in the opening too, ignoring " BOOK_FILE "\n");
+}
+
+static bool parse_options(int argc, char *argv[], EngineOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+    
+        if (strcmp(arg, "--threads") == 0 && has_value) {
+            options->threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--tt") == 0 && has_value) {
+            options->tt_size_mb = atoi(argv[++i]);
+        } else if (strcmp(arg, "--no-book") == 0) {
+            options->use_book = false;
+        } else {
+            print_usage();
+            return false;
+        }
+    }
+    
+    if (options->threads < 1) options->threads = 1;
+    return true;
+}
+
+int engine_main(int argc, char *argv[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    EngineOptions options = {cores > 0 ? (int)cores : 1, 64, true};
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+    
+    Engine engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    engine.scratch = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    engine.ctx = ai_context_create();
+    if (!engine.board || !engine.scratch || !engine.ctx) {
+        fprintf(stderr, "Failed to create board!\n");
+        return 1;
+    }
+    engine.forced_capture = true;
+    pthread_mutex_init(&engine.output, NULL);
+    
+    EndgameTable *endgame = ai_load_tables();
+    fen_parse(engine.board, FEN_START);
+    
+    engine.tt = options.tt_size_mb > 0 ? tt_create(options.tt_size_mb) : NULL;
+    ai_set_transposition_table(engine.ctx, engine.tt);
+    ai_set_threads(engine.ctx, options.threads);
+    ai_set_endgame_table(engine.ctx, endgame);
+    OpeningBook *book = options.use_book ? book_open(BOOK_FILE) : NULL;
+    engine.book = book;
+    ai_set_abort_flag(engine.ctx, &engine.stop);
+    
+    char line[ENGINE_LINE_LENGTH];
+    bool running = true;
+    while (running && fgets(line, sizeof(line), stdin)) {
+        running = engine_command(&engine, line);
+    }
+    
+    // End of input: a bounded search still reports its move
+    if (running && engine.searching && !engine.infinite) {
+        pthread_join(engine.thread, NULL);
+        engine.searching = false;
+    }
+    engine_stop(&engine);
+    
+    ai_context_free(engine.ctx);
+    book_close(book);
+    endgame_close(endgame);
+    tt_free(engine.tt);
+    board_free(engine.scratch);
+    board_free(engine.board);
+    pthread_mutex_destroy(&engine.output);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+// Persistent engine mode (`checkers --engine`): a line protocol on
+// stdin/stdout in the spirit of UCI, for GUIs and match runners that keep
+// one engine process for a whole game. The transposition table and the
+// killer/history tables stay warm from one move to the next.
+//
+//   isready                              -> readyok
+//   newgame                              forget the previous game's tables
+//   position start|fen <fen> [moves m1 m2 ...]
+//   go [depth N] [movetime MS] [infinite]
+//                                        -> info depth 12 score 35 nodes 1234567 time 998
+//                                           bestmove 11-15   (or bestmove none)
+//   stop                                 end the search, report its best move
+//   forced on|off                        captures forced (default) or optional
+//   fen                                  -> fen <current position>
+//   stats                                -> stats {"nodes": 1234567, ...}
+//                                           counters of the last search (ai.h)
+//   quit
+//
+// The search runs in the background, so stop and isready are answered
+// while it thinks. `go infinite` reports its move only after stop. Moves
+// and positions use the notation of fen.h, scores are from black's point
+// of view like the engine's (see ai.h). Rejected commands are answered
+// with "error <reason>". Positions in the opening book (book.h) get the
+// book's heaviest move at once, without info, unless --no-book is given.
+
+// argv[0] is "--engine"; returns the process exit status
+int engine_main(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,126 @@
+#include "fen.h"
+#include "bitboard.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+static int square_number(int row, int col) {
+    return row * 4 + col / 2 + 1;
+}
+
+bool fen_parse(Board *board, const char *text) {
+    if (board->width != BITBOARD_WIDTH || board->height != BITBOARD_HEIGHT) return false;
+    
+    char cells[BITBOARD_WIDTH * BITBOARD_HEIGHT];
+    memset(cells, '.', sizeof(cells));
+    
+    while (isspace((unsigned char)*text)) text++;
+    
+    char side = (char)toupper((unsigned char)*text++);
+    if (side != 'W' && side != 'B') return false;
+    
+    uint32_t occupied = 0;
+    
+    // Up to two colour sections, each ":W<list>" or ":B<list>"
+    while (*text == ':') {
+        text++;
+        char colour = (char)toupper((unsigned char)*text++);
+        if (colour != 'W' && colour != 'B') return false;
+        
+        while (*text && *text != ':' && !isspace((unsigned char)*text)) {
+            bool king = false;
+            if (toupper((unsigned char)*text) == 'K') {
+                king = true;
+                text++;
+            }
+            if (!isdigit((unsigned char)*text)) return false;
+            
+            int number = 0;
+            while (isdigit((unsigned char)*text)) {
+                number = number * 10 + (*text++ - '0');
+            }
+            if (number < 1 || number > BB_SQUARES) return false;
+            
+            // A square listed twice, or a man on the row it promotes on
+            uint32_t square = 1u << (number - 1);
+            if (occupied & square) return false;
+            if (!king && (square & (colour == 'W' ? BB_TOP_ROW : BB_BOTTOM_ROW))) return false;
+            occupied |= square;
+            
+            Coordinate coord = bitboard_coordinate(number - 1);
+            char piece = colour == 'W' ? (king ? 'B' : 'b') : (king ? 'C' : 'c');
+            cells[board_index(board, coord.row, coord.col)] = piece;
+            
+            if (*text == ',') text++;
+        }
+    }
+    
+    while (isspace((unsigned char)*text)) text++;
+    if (*text) return false;
+    
+    board_init(board, cells, side == 'W');
+    return true;
+}
+
+// Append ":<colour><list>" for the pieces of one side
+static size_t format_side(const Board *board, bool white, char *out, size_t size, size_t used) {
+    used += snprintf(out + used, used < size ? size - used : 0, ":%c", white ? 'W' : 'B');
+    bool first = true;
+    
+    for (int square = 0; square < BB_SQUARES; square++) {
+        Coordinate coord = bitboard_coordinate(square);
+        char piece = board_get(board, coord.row, coord.col);
+        bool own = white ? (piece == 'b' || piece == 'B') : (piece == 'c' || piece == 'C');
+        if (!own) continue;
+        
+        bool king = (piece == 'B' || piece == 'C');
+        used += snprintf(out + used, used < size ? size - used : 0, "%s%s%d",
+                         first ? "" : ",", king ? "K" : "", square + 1);
+        first = false;
+    }
+    return used;
+}
+
+void fen_format(const Board *board, char *out, size_t size) {
+    size_t used = snprintf(out, size, "%c", board->white_to_move ? 'W' : 'B');
+    used = format_side(board, true, out, size, used);
+    format_side(board, false, out, size, used);
+}
+
+void fen_format_move(const Board *board, const Move *move, char *out, size_t size) {
+    size_t used = snprintf(out, size, "%d", square_number(move->from.row, move->from.col));
+    
+    if (!move->is_capture) {
+        snprintf(out + used, used < size ? size - used : 0, "-%d", square_number(move->to.row, move->to.col));
+        return;
+    }
+    
+    int jumps = move->jumps > 0 ? move->jumps : 1;
+    for (int k = 0; k < jumps; k++) {
+        Coordinate landing = board_jump_landing(board, move, k);
+        used += snprintf(out + used, used < size ? size - used : 0, "x%d", square_number(landing.row, landing.col));
+    }
+}
+
+bool fen_parse_move(const Board *board, const char *text, bool forced_capture, Move *move) {
+    MoveList moves;
+    board_generate_all_moves(board, forced_capture, &moves);
+    
+    // Compare against the notation of every legal move; "22x13" also
+    // matches a longer chain from 22 ending on 13
+    for (int i = 0; i < moves.count; i++) {
+        char written[MOVE_TEXT_LENGTH];
+        fen_format_move(board, &moves.moves[i], written, sizeof(written));
+        
+        char short_form[MOVE_TEXT_LENGTH];
+        snprintf(short_form, sizeof(short_form), "%dx%d",
+                 square_number(moves.moves[i].from.row, moves.moves[i].from.col),
+                 square_number(moves.moves[i].to.row, moves.moves[i].to.col));
+        
+        if (strcmp(written, text) == 0 || (moves.moves[i].is_capture && strcmp(short_form, text) == 0)) {
+            *move = moves.moves[i];
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,32 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include "board.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Text notation for 8x8 positions and moves, in the style of PDN FEN:
+//
+//   W:W21,22,23,K30:B1,2,K9
+//
+// The first letter is the side to move, followed by the white and black
+// piece lists; K marks a king. Dark squares are numbered 1-32 row by row
+// from the top-left (row 0, black's back rank): square = row * 4 + col / 2 + 1.
+// Moves are written as "22-17" or, for captures, the whole chain "23x14x5".
+
+#define FEN_MAX_LENGTH 160
+
+// The initial position, white to move
+#define FEN_START "W:W21,22,23,24,25,26,27,28,29,30,31,32:B1,2,3,4,5,6,7,8,9,10,11,12"
+#define MOVE_TEXT_LENGTH (4 * (MAX_JUMPS + 1))
+
+// Parse `text` into an 8x8 board, false on a syntax error, a square listed
+// twice or a man on its promotion row (board unchanged)
+bool fen_parse(Board *board, const char *text);
+void fen_format(const Board *board, char *out, size_t size);
+
+void fen_format_move(const Board *board, const Move *move, char *out, size_t size);
+// Find the legal move written as `text`, false if there is none
+bool fen_parse_move(const Board *board, const char *text, bool forced_capture, Move *move);
+
+#endif
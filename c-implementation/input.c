@@ -28,15 +28,17 @@ bool input_choose_piece(const Board *board, const MoveList *available_pieces, Co
         // Parse coordinate
         if (strlen(input) >= 2 && isdigit(input[0]) && isdigit(input[1])) {
             int coord = atoi(input);
-            chosen->row = coord / 10;
-            chosen->col = coord % 10;
+            int row = coord / 10;
+            int col = coord % 10;
             
-            // Validate bounds
-            if (chosen->row < 0 || chosen->row >= board->height || 
-                chosen->col < 0 || chosen->col >= board->width) {
+            // Validate bounds before narrowing into the Coordinate
+            if (row < 0 || row >= board->height || 
+                col < 0 || col >= board->width) {
                 printf("Coordinate out of bounds! Try again.\n");
                 continue;
             }
+            chosen->row = (int8_t)row;
+            chosen->col = (int8_t)col;
             
             char piece = board_get(board, chosen->row, chosen->col);
             
@@ -106,23 +108,19 @@ bool input_choose_field(const MoveList *valid_moves, Coordinate *chosen) {
         // Parse coordinate
         if (strlen(input) >= 2 && isdigit(input[0]) && isdigit(input[1])) {
             int coord = atoi(input);
-            chosen->row = coord / 10;
-            chosen->col = coord % 10;
+            int row = coord / 10;
+            int col = coord % 10;
             
-            // Check if coordinate is in valid moves
-            bool found = false;
+            // Check if coordinate is in valid moves (compared before
+            // narrowing, so an out-of-range number cannot wrap onto one)
             for (int i = 0; i < valid_moves->count; i++) {
-                if (valid_moves->moves[i].to.row == chosen->row && 
-                    valid_moves->moves[i].to.col == chosen->col) {
-                    found = true;
-                    break;
+                if (valid_moves->moves[i].to.row == row && 
+                    valid_moves->moves[i].to.col == col) {
+                    *chosen = valid_moves->moves[i].to;
+                    return true;
                 }
             }
             
-            if (found) {
-                return true;
-            }
-            
             printf("Selection is not valid! Try again.\n");
             continue;
         }
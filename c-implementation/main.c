@@ -1,13 +1,25 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf
+
 #include "board.h"
 #include "ai.h"
+#include "analyze.h"
+#include "book.h"
+#include "engine.h"
 #include "input.h"
 #include "output.h"
+#include "ponder.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #define BOARD_WIDTH 8
 #define BOARD_HEIGHT 8
+#define TT_SIZE_MB 64
+#define MOVE_TIME_MS 2000     // wall-clock budget per computer move
+#define MAX_DEPTH 64
+#define ENDGAME_MAX_DEPTH 20
 
 bool ending_conditions(Board *board, int figure_counter[2], bool forced_capture) {
     MoveList moves;
@@ -45,7 +57,18 @@ bool ending_conditions(Board *board, int figure_counter[2], bool forced_capture)
     return false;
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--analyze") == 0) {
+        return analyze_main(argc - 1, argv + 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "--engine") == 0) {
+        return engine_main(argc - 1, argv + 1);
+    }
+    if (argc > 1) {
+        fprintf(stderr, "Usage: %s [--analyze [FILE] [options] | --engine [options]]\n", argv[0]);
+        return 1;
+    }
+    
     // Initialize standard checkers board (1D array)
     char initial_board[BOARD_WIDTH * BOARD_HEIGHT] = {
         '.', 'c', '.', 'c', '.', 'c', '.', 'c',
@@ -58,6 +81,11 @@ int main(void) {
         'b', '.', 'b', '.', 'b', '.', 'b', '.'
     };
     
+    // Optional tuned evaluation, see eval_tables.txt
+    if (board_eval_load(BOARD_EVAL_FILE)) {
+        printf("Evaluation tables loaded from %s.\n", BOARD_EVAL_FILE);
+    }
+    
     // Create board
     Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
     if (!board) {
@@ -67,11 +95,42 @@ int main(void) {
     
     board_init(board, initial_board, true);
     
+    SearchContext *ctx = ai_context_create();
+    if (!ctx) {
+        printf("Failed to create the search context!\n");
+        return 1;
+    }
+    
+    TranspositionTable *tt = tt_create(TT_SIZE_MB);
+    if (!tt) {
+        printf("Failed to allocate the transposition table, searching without it.\n");
+    }
+    ai_set_transposition_table(ctx, tt);
+    
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    ai_set_threads(ctx, cores > 0 ? (int)cores : 1);
+    
+    // Optional, built with `make tables`
+    EndgameTable *endgame = endgame_open(ENDGAME_FILE);
+    if (endgame) {
+        printf("Endgame table loaded (up to %d pieces).\n", endgame_max_pieces(endgame));
+    }
+    ai_set_endgame_table(ctx, endgame);
+    
+    // Optional, built with `make book`; weighted random choice among the book moves
+    OpeningBook *book = book_open(BOOK_FILE);
+    if (book) {
+        printf("Opening book loaded (%llu entries).\n", (unsigned long long)book_size(book));
+        srand((unsigned int)time(NULL));
+    }
+    
     // Game settings
     bool forced_capture = input_forced_moves();
     
-    int depth = 6;
-    double time_previous_move = 4.5;
+    // Search the replies while the player thinks
+    PonderSettings ponder_settings = {MOVE_TIME_MS, MAX_DEPTH, ENDGAME_MAX_DEPTH, forced_capture};
+    Ponder *ponder = ponder_create(ctx, &ponder_settings);
+    
     int without_capture[2] = {0, 0};
     
     printf("\n=== Checkers Game with Alpha-Beta Pruning ===\n");
@@ -86,8 +145,6 @@ int main(void) {
             break;
         }
         
-        printf("\nCurrent depth: %d\n", depth);
-        
         // Find available capturing pieces
         MoveList available_pieces;
         board_find_capturing_moves(board, &available_pieces);
@@ -138,13 +195,20 @@ int main(void) {
         Board *previous_board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
         board_copy(previous_board, board);
         
-        // Apply move
-        Move player_move = {piece, new_position, false};
-        // Check if it's a capture
-        if (abs(piece.row - new_position.row) == 2) {
-            player_move.is_capture = true;
+        // Apply the move ending on the chosen field (a capture chain is one move)
+        Move played = valid_moves.moves[0];
+        for (int i = 0; i < valid_moves.count; i++) {
+            if (valid_moves.moves[i].to.row == new_position.row &&
+                valid_moves.moves[i].to.col == new_position.col) {
+                played = valid_moves.moves[i];
+                board_apply_move(board, &played);
+                break;
+            }
         }
-        board_apply_move(board, &player_move);
+        
+        // The search is the computer's again
+        SearchResult result;
+        bool ponder_hit = ponder && ponder_stop(ponder, &played, &result);
         
         // Show the move
         MoveList differences;
@@ -163,44 +227,61 @@ int main(void) {
         printf("--- Computer's turn (Black) ---\n");
         printf("THINKING...\n");
         
-        MoveList computer_moves;
-        board_generate_all_moves(board, forced_capture, &computer_moves);
-        int num_moves = computer_moves.count;
-        
-        depth = ai_determine_dynamic_depth(time_previous_move, depth, forced_capture, num_moves);
-        
         previous_board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
         board_copy(previous_board, board);
         
-        clock_t start = clock();
-        
-        int num_white, num_black;
-        board_count_pieces(board, &num_white, &num_black);
+        bool book_hit = !ponder_hit && book_probe(book, board, forced_capture, (uint32_t)rand(), &result.best_move);
         
-        Move best_move;
-        if (num_white + num_black > 6) {
-            // Use standard evaluation
-            best_move = ai_find_best_move(board, depth, forced_capture, evaluate_standard);
+        if (ponder_hit) {
+            // Searched in full during the player's turn
+        } else if (book_hit) {
+            // Known opening, no search
         } else {
-            // Use ending evaluation with deeper search
-            best_move = ai_find_best_move(board, 20, forced_capture, evaluate_ending);
+            // The ending evaluation searches deeper
+            EvaluationFunc eval_func = ai_default_evaluation(board);
+            int max_depth = eval_func == evaluate_ending ? ENDGAME_MAX_DEPTH : MAX_DEPTH;
+            result = ai_search_timed(ctx, board, MOVE_TIME_MS, max_depth, forced_capture, eval_func);
         }
+        board_apply_move(board, &result.best_move);
         
-        board_apply_move(board, &best_move);
-        
-        clock_t end = clock();
-        time_previous_move = (double)(end - start) / CLOCKS_PER_SEC;
+        if (ponder_hit) {
+            printf("Ponder hit: searched during your turn (depth %d)\n", result.depth);
+        } else if (book_hit) {
+            printf("Book move\n");
+        } else {
+            printf("Time taken: %.2f seconds (depth %d)\n", result.time_ms / 1000.0, result.depth);
+            
+            SearchStats stats;
+            ai_get_search_stats(ctx, &stats);
+            printf("Search: %llu nodes, branching factor %.2f, deepest ply %d\n",
+                   stats.nodes, ai_stats_branching_factor(&stats), stats.max_ply);
+        }
+        ai_reset_search_stats(ctx);
         
-        printf("Time taken: %.2f seconds\n", time_previous_move);
+        if (tt) {
+            TTStats stats;
+            tt_get_stats(tt, &stats);
+            printf("Transposition table hit rate: %.1f%% (%llu probes)\n", stats.hit_rate * 100.0, stats.probes);
+            tt_reset_stats(tt);
+        }
         
         board_find_differences(board, previous_board, &differences);
         print_board(board, &differences, NULL);
         printf("Computer played a move displayed on the table above.\n\n");
         
         board_free(previous_board);
+        
+        if (ponder && !board_is_game_over(board)) {
+            ponder_start(ponder, board);
+        }
     }
     
+    ponder_free(ponder);
     board_free(board);
+    ai_context_free(ctx);
+    tt_free(tt);
+    book_close(book);
+    endgame_close(endgame);
     
     printf("\n=== Game Over ===\n");
     return 0;
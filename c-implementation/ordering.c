@@ -0,0 +1,100 @@
+#include "ordering.h"
+#include <string.h>
+
+// Stage offsets, higher is searched first. History scores stay below SCORE_KILLER.
+#define SCORE_HASH (1 << 30)
+#define SCORE_CAPTURE (1 << 29)
+#define SCORE_KILLER (1 << 28)
+#define HISTORY_LIMIT (1 << 20)
+
+void ordering_clear(MoveOrdering *ordering) {
+    memset(ordering, 0, sizeof(MoveOrdering));
+}
+
+void ordering_new_search(MoveOrdering *ordering) {
+    memset(ordering->killer_count, 0, sizeof(ordering->killer_count));
+    
+    for (int i = 0; i < ORDERING_CELLS; i++) {
+        for (int j = 0; j < ORDERING_CELLS; j++) {
+            ordering->history[i][j] /= 8;
+        }
+    }
+}
+
+void ordering_record_cutoff(MoveOrdering *ordering, const Board *board, const Move *move, int depth, int ply) {
+    if (move->is_capture || ply >= ORDERING_MAX_PLY) return;
+    
+    // Two killer slots, newest first
+    if (ordering->killer_count[ply] == 0 || !board_moves_equal(&ordering->killers[ply][0], move)) {
+        ordering->killers[ply][1] = ordering->killers[ply][0];
+        ordering->killers[ply][0] = *move;
+        if (ordering->killer_count[ply] < 2) {
+            ordering->killer_count[ply]++;
+        }
+    }
+    
+    int from = board_index(board, move->from.row, move->from.col);
+    int to = board_index(board, move->to.row, move->to.col);
+    if (from >= ORDERING_CELLS || to >= ORDERING_CELLS) return;
+    
+    ordering->history[from][to] += depth * depth;
+    if (ordering->history[from][to] > HISTORY_LIMIT) {
+        for (int i = 0; i < ORDERING_CELLS; i++) {
+            for (int j = 0; j < ORDERING_CELLS; j++) {
+                ordering->history[i][j] /= 2;
+            }
+        }
+    }
+}
+
+void picker_init(MovePicker *picker, const MoveList *moves, const Board *board,
+                 const MoveOrdering *ordering, int ply, int hash_from, int hash_to) {
+    picker->moves = moves;
+    picker->picked = 0;
+    
+    for (int i = 0; i < moves->count; i++) {
+        const Move *move = &moves->moves[i];
+        int from = board_index(board, move->from.row, move->from.col);
+        int to = board_index(board, move->to.row, move->to.col);
+        int score = 0;
+        
+        if (from == hash_from && to == hash_to) {
+            score = SCORE_HASH;
+        } else if (move->is_capture) {
+            score = SCORE_CAPTURE;
+        } else if (ordering) {
+            if (ply < ORDERING_MAX_PLY && ordering->killer_count[ply] > 0 &&
+                board_moves_equal(move, &ordering->killers[ply][0])) {
+                score = SCORE_KILLER + 1;
+            } else if (ply < ORDERING_MAX_PLY && ordering->killer_count[ply] > 1 &&
+                       board_moves_equal(move, &ordering->killers[ply][1])) {
+                score = SCORE_KILLER;
+            } else if (from < ORDERING_CELLS && to < ORDERING_CELLS) {
+                score = ordering->history[from][to];
+            }
+        }
+        
+        picker->scores[i] = score;
+        picker->order[i] = i;
+    }
+}
+
+int picker_next(MovePicker *picker) {
+    int count = picker->moves->count;
+    if (picker->picked >= count) return -1;
+    
+    // Selection of the best remaining move; ties keep generator order
+    int best = picker->picked;
+    for (int i = picker->picked + 1; i < count; i++) {
+        if (picker->scores[picker->order[i]] > picker->scores[picker->order[best]]) {
+            best = i;
+        }
+    }
+    
+    int index = picker->order[best];
+    memmove(&picker->order[picker->picked + 1], &picker->order[picker->picked],
+            (best - picker->picked) * sizeof(int));
+    picker->order[picker->picked++] = index;
+    
+    return index;
+}
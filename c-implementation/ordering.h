@@ -0,0 +1,39 @@
+#ifndef ORDERING_H
+#define ORDERING_H
+
+#include "board.h"
+
+// Move ordering for the alpha-beta search: killer moves per ply, a history
+// table indexed by from/to cell and a picker that hands out moves in stages:
+// hash move, captures, killers, then quiet moves by history score.
+
+#define ORDERING_MAX_PLY 128
+#define ORDERING_CELLS 64     // history covers boards of up to 64 cells
+
+typedef struct MoveOrdering {
+    Move killers[ORDERING_MAX_PLY][2];
+    int killer_count[ORDERING_MAX_PLY];
+    int history[ORDERING_CELLS][ORDERING_CELLS];
+} MoveOrdering;
+
+typedef struct MovePicker {
+    const MoveList *moves;
+    int scores[MAX_MOVES];
+    int order[MAX_MOVES];     // move indices, already picked ones first
+    int picked;
+} MovePicker;
+
+void ordering_clear(MoveOrdering *ordering);
+// Forget killers and age the history before a new search
+void ordering_new_search(MoveOrdering *ordering);
+// Record a quiet move that caused a cutoff at `ply` with `depth` remaining
+void ordering_record_cutoff(MoveOrdering *ordering, const Board *board, const Move *move, int depth, int ply);
+
+// `ordering` may be NULL (generator order), hash_from/hash_to are cell
+// indices of the transposition table move or -1
+void picker_init(MovePicker *picker, const MoveList *moves, const Board *board,
+                 const MoveOrdering *ordering, int ply, int hash_from, int hash_to);
+// Index into the move list of the next move to search, -1 when done
+int picker_next(MovePicker *picker);
+
+#endif
@@ -0,0 +1,268 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, sysconf
+
+#include "board.h"
+#include "fen.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Move generator test: counts the leaf nodes of the full game tree to a
+// fixed depth. No evaluation, no pruning, so the numbers can be compared
+// against published checkers perft results and the time measures raw
+// generation plus make/unmake throughput.
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+#define MAX_THREADS 64
+#define MAX_DEPTH_SCRATCH 32  // deepest supported perft
+
+typedef struct PerftOptions {
+    const char *fen;
+    int depth;
+    int threads;
+    bool forced_capture;
+    bool divide;         // leaf count per root move
+    bool bulk;           // count the moves at depth 1 instead of playing them
+    bool copy;           // board_copy + board_apply_move instead of make/unmake
+    bool scalar;         // scalar generator instead of the bitboard one
+} PerftOptions;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static unsigned long long perft(Board *board, int depth, const PerftOptions *options) {
+    if (depth == 0) {
+        return 1;
+    }
+    
+    MoveList moves;
+    board_generate_all_moves(board, options->forced_capture, &moves);
+    
+    if (depth == 1 && options->bulk) {
+        return (unsigned long long)moves.count;
+    }
+    
+    unsigned long long nodes = 0;
+    for (int i = 0; i < moves.count; i++) {
+        MoveUndo undo;
+        board_make_move(board, &moves.moves[i], &undo);
+        nodes += perft(board, depth - 1, options);
+        board_unmake_move(board, &moves.moves[i], &undo);
+    }
+    return nodes;
+}
+
+// Same tree walk on board copies, one per ply, through board_apply_move
+static unsigned long long perft_copy(Board *board, Board **scratch, int depth, const PerftOptions *options) {
+    if (depth == 0) {
+        return 1;
+    }
+    
+    MoveList moves;
+    board_generate_all_moves(board, options->forced_capture, &moves);
+    
+    if (depth == 1 && options->bulk) {
+        return (unsigned long long)moves.count;
+    }
+    
+    unsigned long long nodes = 0;
+    Board *child = scratch[0];
+    for (int i = 0; i < moves.count; i++) {
+        board_copy(child, board);
+        board_apply_move(child, &moves.moves[i]);
+        nodes += perft_copy(child, scratch + 1, depth - 1, options);
+    }
+    return nodes;
+}
+
+// Root moves are handed out one at a time to the worker threads
+typedef struct PerftRoot {
+    const PerftOptions *options;
+    const Board *position;
+    MoveList moves;
+    unsigned long long counts[MAX_MOVES];
+    pthread_mutex_t lock;
+    int next;
+} PerftRoot;
+
+static void* perft_worker(void *arg) {
+    PerftRoot *root = (PerftRoot*)arg;
+    const PerftOptions *options = root->options;
+    int depth = options->depth;
+    
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    Board *scratch[MAX_DEPTH_SCRATCH];
+    int boards = 0;
+    if (board) {
+        board_copy(board, root->position);
+        for (; options->copy && boards < depth && boards < MAX_DEPTH_SCRATCH; boards++) {
+            scratch[boards] = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+            if (!scratch[boards]) break;
+        }
+    }
+    bool ready = board && (!options->copy || boards == depth);
+    
+    while (ready) {
+        pthread_mutex_lock(&root->lock);
+        int i = root->next++;
+        pthread_mutex_unlock(&root->lock);
+        
+        if (i >= root->moves.count) {
+            break;
+        }
+        
+        if (options->copy) {
+            board_copy(scratch[0], board);
+            board_apply_move(scratch[0], &root->moves.moves[i]);
+            root->counts[i] = perft_copy(scratch[0], scratch + 1, depth - 1, options);
+        } else {
+            MoveUndo undo;
+            board_make_move(board, &root->moves.moves[i], &undo);
+            root->counts[i] = perft(board, depth - 1, options);
+            board_unmake_move(board, &root->moves.moves[i], &undo);
+        }
+    }
+    
+    for (int b = 0; b < boards; b++) {
+        board_free(scratch[b]);
+    }
+    if (board) {
+        board_free(board);
+    }
+    return NULL;
+}
+
+// Leaf count below every root move, split over the worker threads
+static unsigned long long perft_divide(const Board *board, const PerftOptions *options, PerftRoot *root) {
+    root->options = options;
+    root->position = board;
+    root->next = 0;
+    board_generate_all_moves(board, options->forced_capture, &root->moves);
+    memset(root->counts, 0, sizeof(root->counts));
+    pthread_mutex_init(&root->lock, NULL);
+    
+    int threads = options->threads < root->moves.count ? options->threads : root->moves.count;
+    if (threads < 1) threads = 1;
+    
+    pthread_t handles[MAX_THREADS];
+    bool started[MAX_THREADS] = {false};
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&handles[t], NULL, perft_worker, root) == 0;
+    }
+    perft_worker(root);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(handles[t], NULL);
+        }
+    }
+    pthread_mutex_destroy(&root->lock);
+    
+    unsigned long long nodes = 0;
+    for (int i = 0; i < root->moves.count; i++) {
+        nodes += root->counts[i];
+    }
+    return nodes;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options] [depth]\n"
+            "  --fen FEN        start position (default: initial position)\n"
+            "  --depth N        perft depth (default 8)\n"
+            "  --divide         leaf count per root move\n"
+            "  --bulk           count moves at the last ply instead of playing them\n"
+            "  --threads N      worker threads over the root moves (default 1)\n"
+            "  --copy           use board_copy + board_apply_move instead of make/unmake\n"
+            "  --scalar         use the scalar move generator instead of bitboards\n"
+            "  --no-forced      captures are optional\n"
+            "  --ladder         report every depth from 1 to N\n",
+            program);
+}
+
+int main(int argc, char *argv[]) {
+    PerftOptions options = {FEN_START, 8, 1, true, false, false, false, false};
+    bool ladder = false;
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (strcmp(arg, "--fen") == 0 && has_value) {
+            options.fen = argv[++i];
+        } else if (strcmp(arg, "--depth") == 0 && has_value) {
+            options.depth = atoi(argv[++i]);
+        } else if (strcmp(arg, "--threads") == 0 && has_value) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--divide") == 0) {
+            options.divide = true;
+        } else if (strcmp(arg, "--bulk") == 0) {
+            options.bulk = true;
+        } else if (strcmp(arg, "--copy") == 0) {
+            options.copy = true;
+        } else if (strcmp(arg, "--scalar") == 0) {
+            options.scalar = true;
+        } else if (strcmp(arg, "--no-forced") == 0) {
+            options.forced_capture = false;
+        } else if (strcmp(arg, "--ladder") == 0) {
+            ladder = true;
+        } else if (arg[0] != '-') {
+            options.depth = atoi(arg);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (options.depth < 1 || options.depth > MAX_DEPTH_SCRATCH) {
+        fprintf(stderr, "Depth must be between 1 and %d\n", MAX_DEPTH_SCRATCH);
+        return 1;
+    }
+    if (options.threads < 1) options.threads = 1;
+    if (options.threads > MAX_THREADS) options.threads = MAX_THREADS;
+    
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    if (!board) {
+        fprintf(stderr, "Failed to create board!\n");
+        return 1;
+    }
+    if (!fen_parse(board, options.fen)) {
+        fprintf(stderr, "Invalid position '%s'\n", options.fen);
+        board_free(board);
+        return 1;
+    }
+    board->use_bitboards = !options.scalar;
+    
+    printf("%s\n", options.fen);
+    printf("%-6s %-16s %-10s %s\n", "depth", "nodes", "ms", "nodes/s");
+    
+    PerftRoot root;
+    int first = ladder ? 1 : options.depth;
+    int last = options.depth;
+    for (int depth = first; depth <= last; depth++) {
+        options.depth = depth;
+        double start = now_ms();
+        unsigned long long nodes = perft_divide(board, &options, &root);
+        double ms = now_ms() - start;
+        
+        printf("%-6d %-16llu %-10.1f %.0f\n", depth, nodes, ms, ms > 0 ? nodes * 1000.0 / ms : 0.0);
+    }
+    
+    if (options.divide) {
+        printf("\n");
+        for (int i = 0; i < root.moves.count; i++) {
+            char text[MOVE_TEXT_LENGTH];
+            fen_format_move(board, &root.moves.moves[i], text, sizeof(text));
+            printf("%-12s %llu\n", text, root.counts[i]);
+        }
+        printf("%-12s %d\n", "moves", root.moves.count);
+    }
+    
+    board_free(board);
+    return 0;
+}
@@ -0,0 +1,112 @@
+#define _POSIX_C_SOURCE 200809L  // pthreads
+
+#include "ponder.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+struct Ponder {
+    SearchContext *ctx;
+    PonderSettings settings;
+    Board *board;               // position with the opponent to move
+    pthread_t thread;
+    bool running;               // thread started and not joined yet
+    volatile bool stop;
+    
+    // Replies in search order, predicted reply first. Written by the
+    // thread, read after it has been joined.
+    MoveList replies;
+    SearchResult results[MAX_MOVES];
+    bool searched[MAX_MOVES];   // the search ended on its own, not on stop
+};
+
+// Searched like the computer's move: the ending evaluation goes deeper
+static SearchResult search_position(Ponder *ponder, Board *board) {
+    const PonderSettings *settings = &ponder->settings;
+    EvaluationFunc eval_func = ai_default_evaluation(board);
+    int max_depth = eval_func == evaluate_ending ? settings->ending_max_depth : settings->max_depth;
+    return ai_search_timed(ponder->ctx, board, settings->budget_ms, max_depth, settings->forced_capture, eval_func);
+}
+
+static void *ponder_thread(void *arg) {
+    Ponder *ponder = (Ponder*)arg;
+    
+    for (int i = 0; i < ponder->replies.count && !ponder->stop; i++) {
+        MoveUndo undo;
+        board_make_move(ponder->board, &ponder->replies.moves[i], &undo);
+        ponder->results[i] = search_position(ponder, ponder->board);
+        ponder->searched[i] = !ponder->stop;
+        board_unmake_move(ponder->board, &ponder->replies.moves[i], &undo);
+    }
+    return NULL;
+}
+
+Ponder* ponder_create(SearchContext *ctx, const PonderSettings *settings) {
+    Ponder *ponder = (Ponder*)calloc(1, sizeof(Ponder));
+    if (!ponder) return NULL;
+    
+    ponder->ctx = ctx;
+    ponder->settings = *settings;
+    return ponder;
+}
+
+void ponder_free(Ponder *ponder) {
+    if (!ponder) return;
+    
+    ponder_stop(ponder, NULL, NULL);
+    free(ponder);
+}
+
+void ponder_start(Ponder *ponder, const Board *board) {
+    ponder_stop(ponder, NULL, NULL);
+    
+    ponder->board = board_create(board->width, board->height);
+    if (!ponder->board) return;
+    board_copy(ponder->board, board);
+    
+    // The predicted reply goes first, the others keep generator order
+    board_generate_all_moves(board, ponder->settings.forced_capture, &ponder->replies);
+    Move predicted;
+    if (ai_hash_move(ponder->ctx, board, ponder->settings.forced_capture, &predicted)) {
+        for (int i = 1; i < ponder->replies.count; i++) {
+            if (board_moves_equal(&ponder->replies.moves[i], &predicted)) {
+                ponder->replies.moves[i] = ponder->replies.moves[0];
+                ponder->replies.moves[0] = predicted;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < ponder->replies.count; i++) {
+        ponder->searched[i] = false;
+    }
+    
+    ponder->stop = false;
+    ai_set_abort_flag(ponder->ctx, &ponder->stop);
+    ponder->running = pthread_create(&ponder->thread, NULL, ponder_thread, ponder) == 0;
+    if (!ponder->running) {
+        ai_set_abort_flag(ponder->ctx, NULL);
+    }
+}
+
+bool ponder_stop(Ponder *ponder, const Move *played, SearchResult *result) {
+    if (ponder->running) {
+        ponder->stop = true;
+        pthread_join(ponder->thread, NULL);
+        ponder->running = false;
+        ai_set_abort_flag(ponder->ctx, NULL);
+    }
+    if (!ponder->board) return false;
+    
+    bool hit = false;
+    for (int i = 0; played && i < ponder->replies.count; i++) {
+        if (ponder->searched[i] && board_moves_equal(&ponder->replies.moves[i], played)) {
+            *result = ponder->results[i];
+            hit = true;
+            break;
+        }
+    }
+    
+    board_free(ponder->board);
+    ponder->board = NULL;
+    ponder->replies.count = 0;
+    return hit;
+}
@@ -0,0 +1,40 @@
+#ifndef PONDER_H
+#define PONDER_H
+
+#include "ai.h"
+#include "board.h"
+#include <stdbool.h>
+
+// Pondering: while the opponent thinks, a background thread searches the
+// positions after each of their replies, the one the last search expects
+// first. When the reply that was actually played has been searched in full
+// its result is handed over and the move is played at once; otherwise the
+// regular search starts with a transposition table warmed up by pondering.
+//
+// Pondering searches with the caller's context, so its transposition table
+// and move ordering stay warm for the caller's own search. Between
+// ponder_start and ponder_stop the caller must not search with it.
+
+// How the engine would search the positions after the replies
+typedef struct PonderSettings {
+    int budget_ms;
+    int max_depth;          // standard evaluation, more than 6 pieces
+    int ending_max_depth;   // ending evaluation, 6 pieces or fewer
+    bool forced_capture;
+} PonderSettings;
+
+typedef struct Ponder Ponder;
+
+Ponder* ponder_create(SearchContext *ctx, const PonderSettings *settings);
+// Stops pondering first
+void ponder_free(Ponder *ponder);
+
+// Start searching the replies to `board` (the opponent to move) in the
+// background. The board is copied.
+void ponder_start(Ponder *ponder, const Board *board);
+
+// Stop pondering. True if the position after `played` was searched in full,
+// with its result in *result; `played` may be NULL to just stop.
+bool ponder_stop(Ponder *ponder, const Move *played, SearchResult *result);
+
+#endif
@@ -0,0 +1,546 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, sysconf, strtok_r
+
+#include "ai.h"
+#include "board.h"
+#include "endgame.h"
+#include "fen.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Engine against engine matches between two search configurations A and B.
+// Every opening is played twice with the colors swapped, so neither side
+// profits from a lopsided opening. Games run in parallel, each on its own
+// board with one search context per player, and are adjudicated as in the
+// game loop of main.c: a side without moves loses, 50 plies without a
+// capture are a draw (as is a game longer than SELFPLAY_MAX_PLIES).
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+#define MAX_OPENINGS 1024
+#define OPENING_NAME_LENGTH (2 * MOVE_TEXT_LENGTH)  // room for two moves, "22-18/11-15"
+#define SELFPLAY_DRAW_PLIES 50
+#define SELFPLAY_MAX_PLIES 400
+#define CONFIG_LENGTH 256
+
+typedef enum EvalChoice {
+    EVAL_AUTO,              // ai_default_evaluation, as in the game
+    EVAL_STANDARD,
+    EVAL_ENDING
+} EvalChoice;
+
+// One side of the match, set with "key=value,..." on the command line
+typedef struct PlayerConfig {
+    const char *name;
+    int time_ms;
+    int max_depth;
+    EvalChoice eval;
+    int quiescence;
+    int threads;
+    int tt_size_mb;
+    bool ordering;
+    bool pvs;
+    bool aspiration;
+    bool lmr;
+    bool futility;
+    bool endgame;
+} PlayerConfig;
+
+typedef struct SelfplayOptions {
+    const char *openings_file;  // NULL: all positions two plies after the start
+    int games;
+    int concurrency;
+    bool forced_capture;
+    bool json;
+    PlayerConfig players[2];
+} SelfplayOptions;
+
+typedef struct Opening {
+    char fen[FEN_MAX_LENGTH];
+    char name[OPENING_NAME_LENGTH];
+} Opening;
+
+// Per player totals over all games
+typedef struct PlayerStats {
+    unsigned long long moves;
+    unsigned long long nodes;
+    unsigned long long depth;   // sum of the completed depths
+    double time_ms;
+} PlayerStats;
+
+typedef struct Match {
+    const SelfplayOptions *options;
+    const EndgameTable *endgame;
+    Opening openings[MAX_OPENINGS];
+    int opening_count;
+    
+    pthread_mutex_t lock;
+    int next_game;
+    int finished;
+    int wins, draws, losses;    // from A's point of view
+    PlayerStats stats[2];
+} Match;
+
+// Search state of one player in one worker thread
+typedef struct Player {
+    const PlayerConfig *config;
+    SearchContext *ctx;
+    TranspositionTable *tt;
+} Player;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static bool player_init(Player *player, const PlayerConfig *config, const EndgameTable *endgame) {
+    player->config = config;
+    player->ctx = ai_context_create();
+    player->tt = config->tt_size_mb > 0 ? tt_create((size_t)config->tt_size_mb) : NULL;
+    if (!player->ctx) return false;
+    
+    ai_set_transposition_table(player->ctx, player->tt);
+    ai_set_threads(player->ctx, config->threads);
+    ai_set_move_ordering(player->ctx, config->ordering);
+    ai_set_pvs(player->ctx, config->pvs);
+    ai_set_aspiration(player->ctx, config->aspiration);
+    ai_set_lmr(player->ctx, config->lmr);
+    ai_set_futility(player->ctx, config->futility);
+    ai_set_quiescence_depth(player->ctx, config->quiescence);
+    ai_set_endgame_table(player->ctx, config->endgame ? endgame : NULL);
+    return true;
+}
+
+static void player_free(Player *player) {
+    ai_context_free(player->ctx);
+    tt_free(player->tt);
+}
+
+// Forget everything learned in the previous game
+static void player_new_game(Player *player) {
+    if (player->tt) tt_clear(player->tt);
+    ai_clear_move_ordering(player->ctx);
+}
+
+static EvaluationFunc choose_eval(const PlayerConfig *config, const Board *board) {
+    if (config->eval == EVAL_STANDARD) return evaluate_standard;
+    if (config->eval == EVAL_ENDING) return evaluate_ending;
+    return ai_default_evaluation(board);
+}
+
+// Play one game, returns 1 if white won, -1 if black won, 0 for a draw.
+// players[0] plays white. Search totals go to stats[0] and stats[1].
+static int play_game(Board *board, Player *players[2], bool forced_capture, PlayerStats stats[2], int *plies) {
+    int pieces = -1;
+    int quiet = 0;
+    
+    for (*plies = 0; *plies < SELFPLAY_MAX_PLIES; (*plies)++) {
+        int num_white, num_black;
+        board_count_pieces(board, &num_white, &num_black);
+        if (num_white + num_black == pieces) {
+            if (++quiet >= SELFPLAY_DRAW_PLIES) return 0;
+        } else {
+            pieces = num_white + num_black;
+            quiet = 0;
+        }
+    
+        MoveList moves;
+        board_generate_all_moves(board, forced_capture, &moves);
+        if (moves.count == 0) {
+            return board->white_to_move ? -1 : 1;
+        }
+    
+        int side = board->white_to_move ? 0 : 1;
+        Player *player = players[side];
+        ai_reset_search_stats(player->ctx);
+        SearchResult result = ai_search_timed(player->ctx, board, player->config->time_ms, player->config->max_depth,
+                                              forced_capture, choose_eval(player->config, board));
+        SearchStats search;
+        ai_get_search_stats(player->ctx, &search);
+    
+        stats[side].moves++;
+        stats[side].nodes += search.nodes;
+        stats[side].depth += (unsigned long long)result.depth;
+        stats[side].time_ms += result.time_ms;
+    
+        board_apply_move(board, &result.best_move);
+    }
+    return 0;
+}
+
+static void *worker_thread(void *arg) {
+    Match *match = (Match*)arg;
+    const SelfplayOptions *options = match->options;
+    
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    Player players[2];
+    memset(players, 0, sizeof(players));
+    bool ready = board != NULL;
+    for (int p = 0; p < 2; p++) {
+        ready = player_init(&players[p], &options->players[p], match->endgame) && ready;
+    }
+    
+    while (ready) {
+        pthread_mutex_lock(&match->lock);
+        int game = match->next_game++;
+        pthread_mutex_unlock(&match->lock);
+        if (game >= options->games) break;
+    
+        // Games 2k and 2k + 1 play opening k with the colors swapped
+        const Opening *opening = &match->openings[(game / 2) % match->opening_count];
+        bool a_white = (game % 2) == 0;
+        fen_parse(board, opening->fen);
+    
+        Player *sides[2] = {&players[a_white ? 0 : 1], &players[a_white ? 1 : 0]};
+        player_new_game(sides[0]);
+        player_new_game(sides[1]);
+    
+        PlayerStats stats[2];
+        memset(stats, 0, sizeof(stats));
+        int plies;
+        int white_result = play_game(board, sides, options->forced_capture, stats, &plies);
+        int a_result = a_white ? white_result : -white_result;
+    
+        pthread_mutex_lock(&match->lock);
+        if (a_result > 0) match->wins++;
+        else if (a_result < 0) match->losses++;
+        else match->draws++;
+        for (int side = 0; side < 2; side++) {
+            PlayerStats *total = &match->stats[(side == 0) == a_white ? 0 : 1];
+            total->moves += stats[side].moves;
+            total->nodes += stats[side].nodes;
+            total->depth += stats[side].depth;
+            total->time_ms += stats[side].time_ms;
+        }
+        match->finished++;
+        if (!options->json) {
+            fprintf(stderr, "game %d/%d %-18s A %s: %s in %d plies  (+%d =%d -%d)\n",
+                    match->finished, options->games, opening->name, a_white ? "white" : "black",
+                    a_result > 0 ? "win" : (a_result < 0 ? "loss" : "draw"), plies,
+                    match->wins, match->draws, match->losses);
+        }
+        pthread_mutex_unlock(&match->lock);
+    }
+    
+    if (!ready) {
+        fprintf(stderr, "Failed to create a worker's board or search context!\n");
+    }
+    player_free(&players[0]);
+    player_free(&players[1]);
+    board_free(board);
+    return NULL;
+}
+
+// Lines are "<fen> [name]" as in bench_suite.txt
+static bool load_openings(Match *match, const char *path, Board *board) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) && match->opening_count < MAX_OPENINGS) {
+        line_number++;
+        char fen[FEN_MAX_LENGTH];
+        char name[OPENING_NAME_LENGTH] = "";
+        if (line[0] == '#' || sscanf(line, "%159s %31s", fen, name) < 1) continue;
+    
+        if (!fen_parse(board, fen)) {
+            fprintf(stderr, "%s:%d: invalid position '%s'\n", path, line_number, fen);
+            fclose(file);
+            return false;
+        }
+    
+        Opening *opening = &match->openings[match->opening_count++];
+        strcpy(opening->fen, fen);
+        if (name[0]) {
+            strcpy(opening->name, name);
+        } else {
+            snprintf(opening->name, sizeof(opening->name), "opening-%d", match->opening_count);
+        }
+    }
+    fclose(file);
+    
+    if (match->opening_count == 0) {
+        fprintf(stderr, "%s has no positions\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Every position after one move of each side from the start position
+static void generate_openings(Match *match, Board *board, bool forced_capture) {
+    fen_parse(board, FEN_START);
+    MoveList first;
+    board_generate_all_moves(board, forced_capture, &first);
+    
+    for (int i = 0; i < first.count; i++) {
+        char first_text[MOVE_TEXT_LENGTH];
+        fen_format_move(board, &first.moves[i], first_text, sizeof(first_text));
+        MoveUndo first_undo;
+        board_make_move(board, &first.moves[i], &first_undo);
+    
+        MoveList second;
+        board_generate_all_moves(board, forced_capture, &second);
+        for (int j = 0; j < second.count && match->opening_count < MAX_OPENINGS; j++) {
+            char second_text[MOVE_TEXT_LENGTH];
+            fen_format_move(board, &second.moves[j], second_text, sizeof(second_text));
+            MoveUndo second_undo;
+            board_make_move(board, &second.moves[j], &second_undo);
+    
+            Opening *opening = &match->openings[match->opening_count++];
+            fen_format(board, opening->fen, sizeof(opening->fen));
+            snprintf(opening->name, sizeof(opening->name), "%s/%s", first_text, second_text);
+    
+            board_unmake_move(board, &second.moves[j], &second_undo);
+        }
+        board_unmake_move(board, &first.moves[i], &first_undo);
+    }
+}
+
+static double elo_from_score(double score) {
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// JSON has no infinity: an unbounded end of the interval is null
+static void print_json_elo(const char *key, double elo) {
+    if (isinf(elo)) {
+        printf("\"%s\": null, ", key);
+    } else {
+        printf("\"%s\": %.1f, ", key, elo);
+    }
+}
+
+static void print_report(const Match *match, double elapsed_ms) {
+    const SelfplayOptions *options = match->options;
+    int games = match->wins + match->draws + match->losses;
+    double score = games > 0 ? (match->wins + 0.5 * match->draws) / games : 0.5;
+    
+    // 95% interval of the mean game score, turned into Elo
+    double variance = 0.0;
+    if (games > 0) {
+        variance = (match->wins * (1.0 - score) * (1.0 - score) + match->draws * (0.5 - score) * (0.5 - score) +
+                    match->losses * score * score) / games;
+    }
+    double margin = games > 0 ? 1.96 * sqrt(variance / games) : 0.0;
+    bool decided = score <= 0.0 || score >= 1.0;
+    double elo = decided ? 0.0 : elo_from_score(score);
+    double low = score - margin > 0.0 ? elo_from_score(score - margin) : -INFINITY;
+    double high = score + margin < 1.0 ? elo_from_score(score + margin) : INFINITY;
+    
+    if (options->json) {
+        printf("{\"games\": %d, \"wins\": %d, \"draws\": %d, \"losses\": %d, \"score\": %.4f, ",
+               games, match->wins, match->draws, match->losses, score);
+        print_json_elo("elo", decided ? (score >= 1.0 ? INFINITY : -INFINITY) : elo);
+        print_json_elo("elo_low", low);
+        print_json_elo("elo_high", high);
+        printf("\"seconds\": %.1f, \"players\": [", elapsed_ms / 1000.0);
+        for (int p = 0; p < 2; p++) {
+            const PlayerStats *stats = &match->stats[p];
+            double moves = stats->moves > 0 ? (double)stats->moves : 1.0;
+            printf("%s{\"name\": \"%s\", \"moves\": %llu, \"ms_per_move\": %.2f, \"depth_per_move\": %.2f, "
+                   "\"nodes_per_second\": %.0f}", p > 0 ? ", " : "", options->players[p].name, stats->moves,
+                   stats->time_ms / moves, stats->depth / moves,
+                   stats->time_ms > 0 ? stats->nodes * 1000.0 / stats->time_ms : 0.0);
+        }
+        printf("]}\n");
+        return;
+    }
+    
+    printf("\n%d games in %.1fs: A +%d =%d -%d, score %.1f%%\n", games, elapsed_ms / 1000.0,
+           match->wins, match->draws, match->losses, 100.0 * score);
+    if (decided) {
+        printf("Elo difference A - B: unbounded (one side scored every point)\n");
+    } else {
+        printf("Elo difference A - B: %+.1f (95%%: %+.1f to %+.1f)\n", elo, low, high);
+    }
+    printf("\n%-6s %-10s %-12s %-12s %s\n", "player", "moves", "ms/move", "depth/move", "nps");
+    for (int p = 0; p < 2; p++) {
+        const PlayerStats *stats = &match->stats[p];
+        double moves = stats->moves > 0 ? (double)stats->moves : 1.0;
+        printf("%-6s %-10llu %-12.2f %-12.2f %.0f\n", options->players[p].name, stats->moves,
+               stats->time_ms / moves, stats->depth / moves,
+               stats->time_ms > 0 ? stats->nodes * 1000.0 / stats->time_ms : 0.0);
+    }
+}
+
+static bool parse_switch(const char *value, bool *out) {
+    if (strcmp(value, "on") == 0) *out = true;
+    else if (strcmp(value, "off") == 0) *out = false;
+    else return false;
+    return true;
+}
+
+// "time=100,depth=12,eval=standard,pvs=off,..."; unknown keys are errors
+static bool parse_config(const char *text, PlayerConfig *config) {
+    char buffer[CONFIG_LENGTH];
+    if (strlen(text) >= sizeof(buffer)) return false;
+    strcpy(buffer, text);
+    
+    char *save = NULL;
+    for (char *item = strtok_r(buffer, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        char *value = strchr(item, '=');
+        if (!value) return false;
+        *value++ = '\0';
+    
+        bool ok = true;
+        if (strcmp(item, "time") == 0) {
+            config->time_ms = atoi(value);
+            ok = config->time_ms > 0;
+        } else if (strcmp(item, "depth") == 0) {
+            config->max_depth = atoi(value);
+            ok = config->max_depth > 0;
+        } else if (strcmp(item, "eval") == 0) {
+            if (strcmp(value, "auto") == 0) config->eval = EVAL_AUTO;
+            else if (strcmp(value, "standard") == 0) config->eval = EVAL_STANDARD;
+            else if (strcmp(value, "ending") == 0) config->eval = EVAL_ENDING;
+            else ok = false;
+        } else if (strcmp(item, "quiescence") == 0) {
+            config->quiescence = atoi(value);
+        } else if (strcmp(item, "threads") == 0) {
+            config->threads = atoi(value);
+        } else if (strcmp(item, "tt") == 0) {
+            config->tt_size_mb = atoi(value);
+        } else if (strcmp(item, "ordering") == 0) {
+            ok = parse_switch(value, &config->ordering);
+        } else if (strcmp(item, "pvs") == 0) {
+            ok = parse_switch(value, &config->pvs);
+        } else if (strcmp(item, "aspiration") == 0) {
+            ok = parse_switch(value, &config->aspiration);
+        } else if (strcmp(item, "lmr") == 0) {
+            ok = parse_switch(value, &config->lmr);
+        } else if (strcmp(item, "futility") == 0) {
+            ok = parse_switch(value, &config->futility);
+        } else if (strcmp(item, "endgame") == 0) {
+            ok = parse_switch(value, &config->endgame);
+        } else {
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --a CONFIG       settings of engine A, e.g. time=100,pvs=off\n"
+            "  --b CONFIG       settings of engine B\n"
+            "  --openings FILE  start positions, \"<fen> [name]\" per line (default: every\n"
+            "                   position after one move of each side)\n"
+            "  --games N        games, two per opening with colors swapped (default: all openings)\n"
+            "  --concurrency N  games played at the same time (default: one per core)\n"
+            "  --no-forced      captures are optional\n"
+            "  --json           machine-readable summary\n"
+            "CONFIG keys: time=MS (default 100), depth=N (64), eval=auto|standard|ending,\n"
+            "  quiescence=N (%d), threads=N (1), tt=MB (16),\n"
+            "  ordering|pvs|aspiration|lmr|endgame=on|off (on), futility=on|off (off)\n",
+            program, AI_DEFAULT_QUIESCENCE_DEPTH);
+}
+
+static bool parse_options(int argc, char *argv[], SelfplayOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+    
+        if (strcmp(arg, "--a") == 0 && has_value) {
+            if (!parse_config(argv[++i], &options->players[0])) {
+                fprintf(stderr, "Invalid configuration '%s'\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(arg, "--b") == 0 && has_value) {
+            if (!parse_config(argv[++i], &options->players[1])) {
+                fprintf(stderr, "Invalid configuration '%s'\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(arg, "--openings") == 0 && has_value) {
+            options->openings_file = argv[++i];
+        } else if (strcmp(arg, "--games") == 0 && has_value) {
+            options->games = atoi(argv[++i]);
+        } else if (strcmp(arg, "--concurrency") == 0 && has_value) {
+            options->concurrency = atoi(argv[++i]);
+        } else if (strcmp(arg, "--no-forced") == 0) {
+            options->forced_capture = false;
+        } else if (strcmp(arg, "--json") == 0) {
+            options->json = true;
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    
+    if (options->concurrency < 1) options->concurrency = 1;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    PlayerConfig defaults = {"A", 100, 64, EVAL_AUTO, AI_DEFAULT_QUIESCENCE_DEPTH, 1, 16, true, true, true, true, false, true};
+    SelfplayOptions options = {NULL, 0, cores > 0 ? (int)cores : 1, true, false, {defaults, defaults}};
+    options.players[1].name = "B";
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+    
+    EndgameTable *endgame = ai_load_tables();
+    
+    Match *match = (Match*)calloc(1, sizeof(Match));
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    if (!match || !board) {
+        fprintf(stderr, "Failed to create board!\n");
+        return 1;
+    }
+    match->options = &options;
+    
+    if (options.openings_file) {
+        if (!load_openings(match, options.openings_file, board)) {
+            return 1;
+        }
+    } else {
+        generate_openings(match, board, options.forced_capture);
+    }
+    board_free(board);
+    if (options.games < 1) {
+        options.games = 2 * match->opening_count;
+    }
+    
+    match->endgame = endgame;
+    pthread_mutex_init(&match->lock, NULL);
+    
+    int workers = options.concurrency < options.games ? options.concurrency : options.games;
+    pthread_t *threads = (pthread_t*)malloc((size_t)workers * sizeof(pthread_t));
+    bool *started = (bool*)calloc((size_t)workers, sizeof(bool));
+    if (!threads || !started) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    
+    if (!options.json) {
+        fprintf(stderr, "%d games from %d openings, %d at a time\n", options.games, match->opening_count, workers);
+    }
+    double start = now_ms();
+    for (int w = 0; w < workers; w++) {
+        started[w] = pthread_create(&threads[w], NULL, worker_thread, match) == 0;
+    }
+    for (int w = 0; w < workers; w++) {
+        if (started[w]) {
+            pthread_join(threads[w], NULL);
+        }
+    }
+    
+    print_report(match, now_ms() - start);
+    
+    pthread_mutex_destroy(&match->lock);
+    endgame_close(endgame);
+    free(started);
+    free(threads);
+    free(match);
+    return 0;
+}
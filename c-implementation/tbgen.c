@@ -0,0 +1,339 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include "board.h"
+#include "bitboard.h"
+#include "endgame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Endgame table generator. Slices are solved from few pieces to many, and
+// within a piece count from few men to many, so every capture or promotion
+// leads into a slice that is already solved. Inside a slice, round n marks
+// the positions whose exact distance to the end of the game is n plies:
+//   - a win in n if the best move reaches a loss in n - 1
+//   - a loss in n if every move reaches a win and the longest is n - 1
+// Positions still open when no round can make progress are draws.
+
+#define BOARD_WIDTH 8
+#define BOARD_HEIGHT 8
+
+// Values while generating: 0 unknown (draw at the end), win in d plies is d,
+// loss in d plies is LOSS_FLAG | d
+#define LOSS_FLAG 0x8000u
+#define DISTANCE_MASK 0x7FFFu
+
+typedef struct Slice {
+    int white_men, white_kings, black_men, black_kings;
+    uint64_t entries;
+    uint16_t *values;
+} Slice;
+
+typedef struct GenOptions {
+    const char *output;
+    int max_pieces;
+    bool forced_capture;
+    bool distance;
+} GenOptions;
+
+static Slice *slices[ENDGAME_MAX_PIECES + 1][ENDGAME_MAX_PIECES + 1][ENDGAME_MAX_PIECES + 1][ENDGAME_MAX_PIECES + 1];
+
+// Distances that occur in the slices solved so far
+static bool distance_seen[DISTANCE_MASK + 1];
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Value of a position in a solved slice or the one being solved
+static uint16_t lookup(const Board *board) {
+    uint32_t own = board->white_to_move ? board->white_pieces : board->black_pieces;
+    if (own == 0) {
+        return LOSS_FLAG;  // lost, nothing left to move
+    }
+    
+    int white_kings = bitboard_popcount(board->white_pieces & board->kings);
+    int black_kings = bitboard_popcount(board->black_pieces & board->kings);
+    int white_men = bitboard_popcount(board->white_pieces) - white_kings;
+    int black_men = bitboard_popcount(board->black_pieces) - black_kings;
+    
+    return slices[white_men][white_kings][black_men][black_kings]->values[endgame_index(board)];
+}
+
+// Try to settle the position on `board` in round `round` (0 is the
+// initial pass that finds positions without moves)
+static uint16_t solve_position(Board *board, int round, bool forced_capture) {
+    MoveList moves;
+    board_generate_all_moves(board, forced_capture, &moves);
+    if (moves.count == 0) {
+        return LOSS_FLAG;
+    }
+    if (round == 0) {
+        return 0;
+    }
+    
+    int shortest_loss = -1;
+    int longest_win = -1;
+    bool all_wins = true;
+    
+    for (int i = 0; i < moves.count; i++) {
+        MoveUndo undo;
+        board_make_move(board, &moves.moves[i], &undo);
+        uint16_t value = lookup(board);
+        board_unmake_move(board, &moves.moves[i], &undo);
+    
+        int distance = value & DISTANCE_MASK;
+        if (value & LOSS_FLAG) {
+            if (shortest_loss < 0 || distance < shortest_loss) shortest_loss = distance;
+        } else if (value) {
+            if (distance > longest_win) longest_win = distance;
+        } else {
+            all_wins = false;
+        }
+    }
+    
+    if (shortest_loss >= 0) {
+        return shortest_loss + 1 == round ? (uint16_t)round : 0;
+    }
+    if (all_wins && longest_win + 1 == round) {
+        return (uint16_t)(LOSS_FLAG | round);
+    }
+    return 0;
+}
+
+// Solve one slice, returns the longest distance in it
+static int solve_slice(Slice *slice, Board *board, bool forced_capture) {
+    uint32_t *open = (uint32_t*)malloc(slice->entries * sizeof(uint32_t));
+    if (!open) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    
+    // Round 0: positions without moves are lost, the rest stays open
+    uint64_t open_count = 0;
+    for (uint64_t index = 0; index < slice->entries; index++) {
+        if (!endgame_position(board, slice->white_men, slice->white_kings,
+                              slice->black_men, slice->black_kings, index)) {
+            continue;
+        }
+        slice->values[index] = solve_position(board, 0, forced_capture);
+        if (!slice->values[index]) {
+            open[open_count++] = (uint32_t)index;
+        }
+    }
+    
+    int longest = 0;
+    for (int round = 1; round <= (int)DISTANCE_MASK; round++) {
+        uint64_t kept = 0;
+        bool progress = false;
+    
+        for (uint64_t i = 0; i < open_count; i++) {
+            uint32_t index = open[i];
+            endgame_position(board, slice->white_men, slice->white_kings,
+                             slice->black_men, slice->black_kings, index);
+    
+            uint16_t value = solve_position(board, round, forced_capture);
+            if (value) {
+                slice->values[index] = value;
+                progress = true;
+            } else {
+                open[kept++] = index;
+            }
+        }
+        open_count = kept;
+    
+        if (progress) {
+            longest = round;
+            continue;
+        }
+        
+        // Nothing at distance `round` in this slice, so the next position
+        // to settle needs a child at a distance found in a solved slice
+        int next = round + 1;
+        while (next <= (int)DISTANCE_MASK && !distance_seen[next - 1]) {
+            next++;
+        }
+        if (next > (int)DISTANCE_MASK) {
+            break;
+        }
+        round = next - 1;
+    }
+    
+    for (uint64_t index = 0; index < slice->entries; index++) {
+        if (slice->values[index]) {
+            distance_seen[slice->values[index] & DISTANCE_MASK] = true;
+        }
+    }
+    
+    free(open);
+    return longest;
+}
+
+static bool write_table(const GenOptions *options, Slice **order, int count) {
+    FILE *file = fopen(options->output, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", options->output);
+        return false;
+    }
+    
+    EndgameHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ENDGAME_MAGIC, 4);
+    header.version = ENDGAME_VERSION;
+    header.max_pieces = (uint32_t)options->max_pieces;
+    header.flags = (options->forced_capture ? ENDGAME_FLAG_FORCED : 0) |
+                   (options->distance ? ENDGAME_FLAG_DISTANCE : 0);
+    header.slice_count = (uint32_t)count;
+    fwrite(&header, sizeof(header), 1, file);
+    
+    uint64_t offset = sizeof(header) + count * sizeof(EndgameSlice);
+    for (int i = 0; i < count; i++) {
+        EndgameSlice entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.white_men = (uint8_t)order[i]->white_men;
+        entry.white_kings = (uint8_t)order[i]->white_kings;
+        entry.black_men = (uint8_t)order[i]->black_men;
+        entry.black_kings = (uint8_t)order[i]->black_kings;
+        entry.offset = offset;
+        entry.entries = order[i]->entries;
+        fwrite(&entry, sizeof(entry), 1, file);
+        offset += options->distance ? entry.entries : (entry.entries + 3) / 4;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        const Slice *slice = order[i];
+        uint8_t packed = 0;
+    
+        for (uint64_t index = 0; index < slice->entries; index++) {
+            uint16_t value = slice->values[index];
+            int result = (value & LOSS_FLAG) ? -1 : (value ? 1 : 0);
+    
+            if (options->distance) {
+                fputc(endgame_encode(result, value & DISTANCE_MASK), file);
+                continue;
+            }
+    
+            int wdl = result > 0 ? 1 : (result < 0 ? 2 : 0);
+            packed |= (uint8_t)(wdl << (2 * (index % 4)));
+            if (index % 4 == 3 || index + 1 == slice->entries) {
+                fputc(packed, file);
+                packed = 0;
+            }
+        }
+    }
+    
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "Error writing %s\n", options->output);
+    }
+    return ok;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --pieces N       largest piece count to solve, 2-%d (default 4)\n"
+            "  --output FILE    table file (default %s)\n"
+            "  --wdl            store win/draw/loss only (2 bits per position)\n"
+            "  --no-forced      captures are optional\n",
+            program, ENDGAME_MAX_PIECES, ENDGAME_FILE);
+}
+
+int main(int argc, char *argv[]) {
+    GenOptions options = {ENDGAME_FILE, 4, true, true};
+    
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+    
+        if (strcmp(arg, "--pieces") == 0 && has_value) {
+            options.max_pieces = atoi(argv[++i]);
+        } else if (strcmp(arg, "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else if (strcmp(arg, "--wdl") == 0) {
+            options.distance = false;
+        } else if (strcmp(arg, "--no-forced") == 0) {
+            options.forced_capture = false;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (options.max_pieces < 2 || options.max_pieces > ENDGAME_MAX_PIECES) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    Board *board = board_create(BOARD_WIDTH, BOARD_HEIGHT);
+    if (!board) {
+        fprintf(stderr, "Failed to create board!\n");
+        return 1;
+    }
+    char empty[BOARD_WIDTH * BOARD_HEIGHT];
+    memset(empty, '.', sizeof(empty));
+    board_init(board, empty, true);
+    
+    // Solving order: piece count, then number of men
+    Slice *order[2048];
+    int count = 0;
+    int longest_known = 0;
+    double start = now_ms();
+    
+    for (int pieces = 2; pieces <= options.max_pieces; pieces++) {
+        for (int men = 0; men <= pieces; men++) {
+            for (int white_men = 0; white_men <= men; white_men++) {
+                int black_men = men - white_men;
+                for (int white_kings = 0; white_kings <= pieces - men; white_kings++) {
+                    int black_kings = pieces - men - white_kings;
+                    if (white_men + white_kings == 0 || black_men + black_kings == 0) continue;
+    
+                    Slice *slice = (Slice*)malloc(sizeof(Slice));
+                    uint64_t entries = endgame_slice_size(white_men, white_kings, black_men, black_kings);
+                    uint16_t *values = slice ? (uint16_t*)calloc(entries, sizeof(uint16_t)) : NULL;
+                    if (!values) {
+                        fprintf(stderr, "Out of memory\n");
+                        return 1;
+                    }
+                    *slice = (Slice){white_men, white_kings, black_men, black_kings, entries, values};
+                    slices[white_men][white_kings][black_men][black_kings] = slice;
+                    order[count++] = slice;
+    
+                    double slice_start = now_ms();
+                    int longest = solve_slice(slice, board, options.forced_capture);
+                    if (longest > longest_known) longest_known = longest;
+    
+                    uint64_t wins = 0, losses = 0;
+                    for (uint64_t index = 0; index < entries; index++) {
+                        if (values[index] & LOSS_FLAG) losses++;
+                        else if (values[index]) wins++;
+                    }
+                    fprintf(stderr, "%dW%dWK %dB%dBK  %10llu positions  %10llu wins  %10llu losses  longest %3d  %.1fs\n",
+                            white_men, white_kings, black_men, black_kings, (unsigned long long)entries,
+                            (unsigned long long)wins, (unsigned long long)losses, longest,
+                            (now_ms() - slice_start) / 1000.0);
+                }
+            }
+        }
+    }
+    
+    if (options.distance && longest_known > ENDGAME_MAX_DISTANCE) {
+        fprintf(stderr, "Distances above %d plies are stored as %d\n", ENDGAME_MAX_DISTANCE, ENDGAME_MAX_DISTANCE);
+    }
+    
+    bool ok = write_table(&options, order, count);
+    if (ok) {
+        fprintf(stderr, "Wrote %d slices to %s in %.1fs\n", count, options.output, (now_ms() - start) / 1000.0);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        free(order[i]->values);
+        free(order[i]);
+    }
+    board_free(board);
+    return ok ? 0 : 1;
+}
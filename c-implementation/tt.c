@@ -0,0 +1,169 @@
+#include "tt.h"
+#include <stdlib.h>
+#include <string.h>
+
+TranspositionTable* tt_create(size_t size_mb) {
+    TranspositionTable *tt = (TranspositionTable*)malloc(sizeof(TranspositionTable));
+    if (!tt) return NULL;
+    
+    // Largest power of two number of buckets that fits the budget
+    size_t bytes = size_mb * 1024 * 1024;
+    size_t bucket_bytes = sizeof(TTSlot) * TT_BUCKET_SIZE;
+    size_t count = 1;
+    while (count * 2 * bucket_bytes <= bytes) {
+        count *= 2;
+    }
+    
+    tt->buckets = calloc(count, bucket_bytes);
+    if (!tt->buckets) {
+        free(tt);
+        return NULL;
+    }
+    
+    tt->bucket_count = count;
+    tt->generation = 0;
+    memset(&tt->stats, 0, sizeof(TTStats));
+    
+    return tt;
+}
+
+void tt_free(TranspositionTable *tt) {
+    if (tt) {
+        free(tt->buckets);
+        free(tt);
+    }
+}
+
+void tt_clear(TranspositionTable *tt) {
+    memset(tt->buckets, 0, tt->bucket_count * sizeof(TTSlot) * TT_BUCKET_SIZE);
+    tt->generation = 0;
+}
+
+void tt_new_search(TranspositionTable *tt) {
+    tt->generation = (tt->generation + 1) & TT_GENERATION_MASK;
+}
+
+static inline uint64_t tt_pack(const TTEntry *entry) {
+    return (uint64_t)(uint32_t)entry->score |
+           (uint64_t)(uint8_t)entry->depth << 32 |
+           (uint64_t)(entry->bound & 3) << 40 |
+           (uint64_t)(entry->generation & TT_GENERATION_MASK) << 42 |
+           (uint64_t)entry->best_from << 48 |
+           (uint64_t)entry->best_to << 56;
+}
+
+static inline TTEntry tt_unpack(uint64_t data) {
+    TTEntry entry;
+    entry.score = (int32_t)(uint32_t)data;
+    entry.depth = (int8_t)(data >> 32);
+    entry.bound = (TTBound)((data >> 40) & 3);
+    entry.generation = (uint8_t)((data >> 42) & TT_GENERATION_MASK);
+    entry.best_from = (uint8_t)(data >> 48);
+    entry.best_to = (uint8_t)(data >> 56);
+    return entry;
+}
+
+static inline TTBound tt_slot_bound(uint64_t data) {
+    return (TTBound)((data >> 40) & 3);
+}
+
+bool tt_probe(const TranspositionTable *tt, uint64_t key, TTEntry *entry) {
+    const TTSlot *bucket = tt->buckets[key & (tt->bucket_count - 1)];
+    
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        // Work on a copy, another thread may be rewriting the slot
+        TTSlot slot;
+        memcpy(&slot, &bucket[i], sizeof(TTSlot));
+        if (tt_slot_bound(slot.data) != TT_NONE && (slot.check ^ slot.data) == key) {
+            *entry = tt_unpack(slot.data);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool tt_store(TranspositionTable *tt, uint64_t key, int depth, TTBound bound, int32_t score, int best_from, int best_to) {
+    TTSlot *bucket = tt->buckets[key & (tt->bucket_count - 1)];
+    TTSlot *victim = NULL;
+    TTEntry old = {0};
+    uint64_t old_key = 0;
+    int victim_value = 0;
+    
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        TTSlot stored;
+        memcpy(&stored, &bucket[i], sizeof(TTSlot));
+        TTEntry slot = tt_unpack(stored.data);
+        uint64_t slot_key = stored.check ^ stored.data;
+        
+        if (slot.bound == TT_NONE || slot_key == key) {
+            // Keep a deeper result of the current search for the same position
+            if (slot.bound != TT_NONE && slot.generation == tt->generation &&
+                slot.depth > depth && bound != TT_EXACT) {
+                return false;
+            }
+            victim = &bucket[i];
+            old = slot;
+            old_key = slot_key;
+            break;
+        }
+        
+        // Shallow entries from old searches go first
+        int value = slot.depth - (slot.generation != tt->generation ? 64 : 0);
+        if (!victim || value < victim_value) {
+            victim = &bucket[i];
+            old = slot;
+            old_key = slot_key;
+            victim_value = value;
+        }
+    }
+    
+    bool same_position = old.bound != TT_NONE && old_key == key;
+    
+    // Keep the old best move when this search did not produce one
+    if (best_from == TT_NO_MOVE && same_position) {
+        best_from = old.best_from;
+        best_to = old.best_to;
+    }
+    
+    TTEntry entry;
+    entry.score = score;
+    entry.depth = depth;
+    entry.bound = bound;
+    entry.generation = tt->generation;
+    entry.best_from = (uint8_t)best_from;
+    entry.best_to = (uint8_t)best_to;
+    
+    TTSlot slot;
+    slot.data = tt_pack(&entry);
+    slot.check = key ^ slot.data;
+    memcpy(victim, &slot, sizeof(TTSlot));
+    
+    return old.bound != TT_NONE && !same_position;
+}
+
+void tt_add_stats(TranspositionTable *tt, const TTStats *stats) {
+    tt->stats.probes += stats->probes;
+    tt->stats.hits += stats->hits;
+    tt->stats.cutoffs += stats->cutoffs;
+    tt->stats.stores += stats->stores;
+    tt->stats.overwrites += stats->overwrites;
+}
+
+void tt_get_stats(const TranspositionTable *tt, TTStats *stats) {
+    *stats = tt->stats;
+    stats->hit_rate = stats->probes ? (double)stats->hits / stats->probes : 0.0;
+    
+    // Sample the first buckets instead of walking a large table
+    size_t sample = tt->bucket_count < 1024 ? tt->bucket_count : 1024;
+    size_t used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (int j = 0; j < TT_BUCKET_SIZE; j++) {
+            if (tt_slot_bound(tt->buckets[i][j].data) != TT_NONE) used++;
+        }
+    }
+    stats->fill = (double)used / (sample * TT_BUCKET_SIZE);
+}
+
+void tt_reset_stats(TranspositionTable *tt) {
+    memset(&tt->stats, 0, sizeof(TTStats));
+}
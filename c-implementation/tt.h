@@ -0,0 +1,81 @@
+#ifndef TT_H
+#define TT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-size transposition table keyed by Board.hash.
+// Entries live in buckets of TT_BUCKET_SIZE; a store replaces the entry with
+// the same key, else an empty one, else the shallowest entry, preferring
+// entries left over from earlier searches.
+//
+// The table can be shared by several search threads without locks: each
+// slot stores its key XORed with its data word, so a read that races with a
+// write fails verification and is treated as a miss.
+
+#define TT_BUCKET_SIZE 4
+#define TT_NO_MOVE 0xFF
+#define TT_GENERATION_MASK 0x3F  // generations are stored in 6 bits
+
+typedef enum TTBound {
+    TT_NONE,
+    TT_EXACT,   // score is the exact value
+    TT_LOWER,   // search failed high, value >= score
+    TT_UPPER    // search failed low, value <= score
+} TTBound;
+
+// Contents of an entry as returned by tt_probe
+typedef struct TTEntry {
+    int32_t score;
+    int depth;
+    TTBound bound;
+    uint8_t generation;
+    uint8_t best_from;    // cell indices of the best move, TT_NO_MOVE if none
+    uint8_t best_to;
+} TTEntry;
+
+// Stored form, 16 bytes. The data word packs, from the low bits: score (32),
+// depth (8), bound (2), generation (6), best_from (8), best_to (8).
+typedef struct TTSlot {
+    uint64_t check;       // key ^ data
+    uint64_t data;
+} TTSlot;
+
+typedef struct TTStats {
+    unsigned long long probes;
+    unsigned long long hits;       // probes that found the position
+    unsigned long long cutoffs;    // hits whose bound ended the node without a search
+    unsigned long long stores;
+    unsigned long long overwrites; // stores that evicted a different position
+    double hit_rate;               // hits / probes
+    double fill;                   // fraction of used entries
+} TTStats;
+
+typedef struct TranspositionTable {
+    TTSlot (*buckets)[TT_BUCKET_SIZE];
+    size_t bucket_count;           // power of two
+    uint8_t generation;
+    TTStats stats;
+} TranspositionTable;
+
+// Create a table using at most size_mb megabytes, NULL on failure
+TranspositionTable* tt_create(size_t size_mb);
+void tt_free(TranspositionTable *tt);
+void tt_clear(TranspositionTable *tt);
+
+// Start a new search: entries from older searches become preferred victims
+void tt_new_search(TranspositionTable *tt);
+
+// Copies the entry for key into *entry, false if the position is not stored
+bool tt_probe(const TranspositionTable *tt, uint64_t key, TTEntry *entry);
+// Returns true when a different position was evicted
+bool tt_store(TranspositionTable *tt, uint64_t key, int depth, TTBound bound, int32_t score, int best_from, int best_to);
+
+// Probing does not touch shared counters; searches count locally and
+// report their totals with tt_add_stats once they finish.
+void tt_add_stats(TranspositionTable *tt, const TTStats *stats);
+void tt_get_stats(const TranspositionTable *tt, TTStats *stats);
+void tt_reset_stats(TranspositionTable *tt);
+
+#endif